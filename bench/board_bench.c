@@ -0,0 +1,340 @@
+/**
+ * Host benchmark for the AVR Mines board engine.
+ *
+ * Plays scripted games from fixed seeds and reports
+ * games per second, as well as the average cost of
+ * generate_mines and reveal_section calls. The same games
+ * are then played with fixed_reveal_section. Last, Expert boards are
+ * cleared into an opening with clear_opening and played by following
+ * solver_hint alone, reporting the average cost of both,
+ * and boards of every preset are generated with solver_generate,
+ * reporting the boards it tried, the calls it took to carry on
+ * with each board, and the time it took.
+ *
+ * Usage: board_bench [games]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "board.h"
+#include "board_fixed.h"
+#include "random.h"
+#include "solver.h"
+
+#define MINE_AMOUNT 14
+#define DEFAULT_GAMES 200000
+// Hints are timed on boards as large as the Expert preset,
+// with one game per HINT_GAME_RATIO games of the board engine.
+#define HINT_WIDTH 30
+#define HINT_HEIGHT 16
+#define HINT_MINES 99
+#define HINT_GAME_RATIO 100
+
+/**
+ * Represent the size of a board generated by solver_generate,
+ * matching the presets of the game.
+ */
+typedef struct generate_size {
+	uint8_t width;
+	uint8_t height;
+	uint16_t mines;
+} GenerateSize;
+
+static const GenerateSize GENERATE_SIZES[] = {
+	{14, 5, 14}, {9, 9, 10}, {16, 16, 40}, {HINT_WIDTH, HINT_HEIGHT, HINT_MINES}
+};
+
+#define GENERATE_SIZE_AMOUNT (sizeof(GENERATE_SIZES) / sizeof(GENERATE_SIZES[0]))
+
+static Field g_board[BOARD_HEIGHT][BOARD_WIDTH];
+// Fields revealed, which the game would redraw.
+static BitRow g_changes[BOARD_HEIGHT];
+static Field g_hint_board[HINT_HEIGHT][HINT_WIDTH];
+static BitRow g_hint_changes[HINT_HEIGHT];
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/**
+ * Play a single game with a scripted player that never selects a mine.
+ * Fields are selected in a fixed order derived from the seed.
+ *
+ * @fixed: reveal with fixed_reveal_section instead of reveal_section
+ * @gen_ns: time spent generating mines is added to this pointer
+ * @reveal_ns: time spent revealing sections is added to this pointer
+ *
+ * @return: the amount of reveal_section calls made
+ */
+static unsigned play_game(
+	unsigned seed, uint8_t fixed, uint64_t *gen_ns, uint64_t *reveal_ns
+) {
+	int fields_left = BOARD_HEIGHT * BOARD_WIDTH - MINE_AMOUNT;
+	unsigned reveals = 0;
+
+	memset(g_board, 0, sizeof(g_board));
+
+	random_seed(seed);
+	uint64_t start = now_ns();
+	generate_mines(BOARD_WIDTH, BOARD_HEIGHT, g_board, MINE_AMOUNT);
+	*gen_ns += now_ns() - start;
+
+	// Step through the board with a stride coprime to its size,
+	// so every field is visited exactly once per game.
+	unsigned cells = BOARD_HEIGHT * BOARD_WIDTH;
+	unsigned pos = seed % cells;
+
+	for (unsigned i = 0; i < cells && fields_left > 0; i++) {
+		pos = (pos + 3) % cells;
+		Field *field = &g_board[pos / BOARD_WIDTH][pos % BOARD_WIDTH];
+
+		if (field_is_mine(*field) || field_is_revealed(*field)) {
+			continue;
+		}
+
+		uint16_t fields_revealed = 0;
+		uint16_t flags_removed = 0;
+
+		start = now_ns();
+
+		if (fixed) {
+			fixed_reveal_section(
+				&fields_revealed, &flags_removed,
+				pos / BOARD_WIDTH, pos % BOARD_WIDTH,
+				g_board, g_changes
+			);
+		} else {
+			reveal_section(
+				&fields_revealed, &flags_removed,
+				pos / BOARD_WIDTH, pos % BOARD_WIDTH,
+				BOARD_WIDTH, BOARD_HEIGHT, g_board, g_changes
+			);
+		}
+
+		*reveal_ns += now_ns() - start;
+
+		fields_left -= fields_revealed;
+		reveals++;
+	}
+
+	if (fields_left != 0) {
+		fprintf(stderr, "seed %u: game did not finish\n", seed);
+		exit(1);
+	}
+
+	return reveals;
+}
+
+/**
+ * Play a single game by following hints, starting from a field
+ * cleared into an opening, like the first field revealed in the game,
+ * until no field can be deduced.
+ * Hints are checked against the mines of the board.
+ *
+ * @opening_ns: time spent in clear_opening is added to this pointer
+ * @moved: the amount of mines moved by it is added to this pointer
+ * @hint_ns: time spent in solver_hint is added to this pointer
+ * @hints: the amount of solver_hint calls is added to this pointer
+ * @unfinished: the amount of calls which ran out of work
+ *	is added to this pointer
+ *
+ * @return: 1 if every empty field was revealed, 0 otherwise.
+ */
+static uint8_t hint_game(
+	unsigned seed, uint64_t *opening_ns, unsigned long *moved,
+	uint64_t *hint_ns, unsigned long *hints, unsigned long *unfinished
+) {
+	int fields_left = HINT_HEIGHT * HINT_WIDTH - HINT_MINES;
+	uint16_t fields_revealed = 0;
+	uint16_t flags_removed = 0;
+	uint8_t row = seed % HINT_HEIGHT;
+	uint8_t col = seed % HINT_WIDTH;
+	BitRow progress[SOLVER_HINT_BITBOARDS * HINT_HEIGHT];
+	uint8_t resumed = 0;
+
+	memset(g_hint_board, 0, sizeof(g_hint_board));
+	random_seed(seed);
+	generate_mines(HINT_WIDTH, HINT_HEIGHT, g_hint_board, HINT_MINES);
+
+	uint64_t start = now_ns();
+	*moved += clear_opening(row, col, HINT_WIDTH, HINT_HEIGHT, g_hint_board);
+	*opening_ns += now_ns() - start;
+
+	if (g_hint_board[row][col] != 0) {
+		fprintf(stderr, "seed %u: no opening at %u,%u\n", seed, row, col);
+		exit(1);
+	}
+
+	reveal_section(
+		&fields_revealed, &flags_removed, row, col,
+		HINT_WIDTH, HINT_HEIGHT, g_hint_board, g_hint_changes
+	);
+
+	while (1) {
+		start = now_ns();
+		Deduction deduction = solver_hint(
+			HINT_WIDTH, HINT_HEIGHT, g_hint_board, &row, &col,
+			progress, resumed
+		);
+
+		*hint_ns += now_ns() - start;
+		(*hints)++;
+		resumed = deduction == DEDUCED_UNFINISHED;
+
+		if (deduction == DEDUCED_NOTHING) {
+			break;
+		}
+
+		// The game carries on with the same hint on the next frame.
+		if (resumed) {
+			(*unfinished)++;
+			continue;
+		}
+
+		Field *field = &g_hint_board[row][col];
+
+		if (!field_is_mine(*field) != (deduction == DEDUCED_SAFE)) {
+			fprintf(stderr, "seed %u: wrong hint at %u,%u\n", seed, row, col);
+			exit(1);
+		}
+
+		if (deduction == DEDUCED_MINE) {
+			field_set(field, FIELD_FLAGGED);
+			continue;
+		}
+
+		reveal_section(
+			&fields_revealed, &flags_removed, row, col,
+			HINT_WIDTH, HINT_HEIGHT, g_hint_board, g_hint_changes
+		);
+	}
+
+	return fields_revealed == fields_left;
+}
+
+/**
+ * Generate boards without guessing from fixed seeds, starting from
+ * the center of the board, and report the boards tried, the calls
+ * of solver_generate and the average time taken per board.
+ *
+ * @boards: the amount of boards to generate
+ */
+static void generate_boards(const GenerateSize *size, unsigned boards)
+{
+	// The board is laid out with the width of the size generated.
+	Field (*board)[size->width] = (Field (*)[size->width]) g_hint_board;
+	uint8_t row = size->height / 2;
+	uint8_t col = size->width / 2;
+	uint64_t total_ns = 0;
+	unsigned long attempts = 0;
+	uint16_t max_attempts = 0;
+	unsigned long calls = 0;
+	unsigned long max_calls = 0;
+	unsigned failed = 0;
+
+	for (unsigned seed = 1; seed <= boards; seed++) {
+		random_seed(seed);
+		reset_board(size->width, size->height, board, size->mines);
+
+		BitRow progress[SOLVER_GENERATE_BITBOARDS * size->height];
+		uint16_t tried = 0;
+		unsigned long board_calls = 0;
+		Generation generation;
+		uint64_t start = now_ns();
+
+		do {
+			generation = solver_generate(
+				size->width, size->height, board, size->mines, row, col,
+				progress, &tried
+			);
+			board_calls++;
+		} while (generation == GENERATED_UNFINISHED);
+
+		total_ns += now_ns() - start;
+		failed += generation == GENERATED_UNSOLVABLE;
+		calls += board_calls;
+		max_calls = board_calls > max_calls ? board_calls : max_calls;
+
+		attempts += tried;
+		max_attempts = tried > max_attempts ? tried : max_attempts;
+	}
+
+	printf("generated board %dx%d, %d mines, %u boards\n",
+		size->width, size->height, size->mines, boards);
+	printf("ns per solver_generate: %10.1f\n", (double) total_ns / boards);
+	printf("boards tried per board: %10.2f\n", (double) attempts / boards);
+	printf("most boards tried:      %10u\n", max_attempts);
+	printf("calls per board:        %10.2f\n", (double) calls / boards);
+	printf("most calls:             %10lu\n", max_calls);
+	printf("boards failed:          %10u\n", failed);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned games = argc > 1 ? (unsigned) atoi(argv[1]) : DEFAULT_GAMES;
+	uint64_t gen_ns = 0;
+	uint64_t reveal_ns = 0;
+	uint64_t fixed_ns = 0;
+	unsigned long reveals = 0;
+
+	if (games == 0) {
+		fprintf(stderr, "usage: %s [games]\n", argv[0]);
+		return 1;
+	}
+
+	uint64_t start = now_ns();
+
+	for (unsigned seed = 1; seed <= games; seed++) {
+		reveals += play_game(seed, 0, &gen_ns, &reveal_ns);
+	}
+
+	double total_s = (now_ns() - start) / 1e9;
+	uint64_t fixed_gen_ns = 0;
+
+	for (unsigned seed = 1; seed <= games; seed++) {
+		play_game(seed, 1, &fixed_gen_ns, &fixed_ns);
+	}
+
+	unsigned hint_games = games / HINT_GAME_RATIO + 1;
+	uint64_t opening_ns = 0;
+	unsigned long moved = 0;
+	uint64_t hint_ns = 0;
+	unsigned long hints = 0;
+	unsigned long unfinished = 0;
+	unsigned solved = 0;
+
+	for (unsigned seed = 1; seed <= hint_games; seed++) {
+		solved += hint_game(
+			seed, &opening_ns, &moved, &hint_ns, &hints, &unfinished
+		);
+	}
+
+	printf("board %dx%d, %d mines, %u games\n",
+		BOARD_WIDTH, BOARD_HEIGHT, MINE_AMOUNT, games);
+	printf("games/sec:            %12.0f\n", games / total_s);
+	printf("ns per generate_mines: %11.1f\n", (double) gen_ns / games);
+	printf("ns per reveal_section: %11.1f\n", (double) reveal_ns / reveals);
+	printf("ns per fixed_reveal:   %11.1f\n", (double) fixed_ns / reveals);
+	printf("reveals per game:      %11.2f\n", (double) reveals / games);
+	printf("hint board %dx%d, %d mines, %u games\n",
+		HINT_WIDTH, HINT_HEIGHT, HINT_MINES, hint_games);
+	printf("ns per clear_opening:  %11.1f\n", (double) opening_ns / hint_games);
+	printf("mines moved per game:  %11.2f\n", (double) moved / hint_games);
+	printf("ns per solver_hint:    %11.1f\n", (double) hint_ns / hints);
+	printf("hints per game:        %11.2f\n", (double) hints / hint_games);
+	printf("unfinished per game:   %11.2f\n", (double) unfinished / hint_games);
+	printf("games solved by hints: %11u\n", solved);
+
+	for (unsigned i = 0; i < GENERATE_SIZE_AMOUNT; i++) {
+		generate_boards(&GENERATE_SIZES[i], hint_games);
+	}
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * Host check of the fixed size board engine of AVR Mines.
+ *
+ * Plays the same random games on two copies of a board, one with
+ * reveal_section and the other with fixed_reveal_section, and fails
+ * as soon as they differ in the fields revealed, the flags removed,
+ * the board itself or the changes logged for the renderer.
+ *
+ * Usage: board_check [games]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "board.h"
+#include "board_fixed.h"
+#include "random.h"
+
+#define DEFAULT_GAMES 20000
+// Actions taken per game at most, if it does not end before.
+#define STEPS 40
+#define FIELD_AMOUNT (BOARD_WIDTH * BOARD_HEIGHT)
+
+static Field g_generic[BOARD_HEIGHT][BOARD_WIDTH];
+static Field g_fixed[BOARD_HEIGHT][BOARD_WIDTH];
+static BitRow g_generic_changes[BOARD_HEIGHT];
+static BitRow g_fixed_changes[BOARD_HEIGHT];
+
+/**
+ * Play a game on both boards with random flags and reveals.
+ *
+ * @return: 0 if both engines agreed all along, 1 otherwise.
+ */
+static int play_game(unsigned seed)
+{
+	random_seed(seed);
+	memset(g_generic, 0, sizeof(g_generic));
+	generate_mines(
+		BOARD_WIDTH, BOARD_HEIGHT, g_generic,
+		1 + random_below(FIELD_AMOUNT / 3)
+	);
+	memcpy(g_fixed, g_generic, sizeof(g_fixed));
+
+	for (uint8_t step = 0; step < STEPS; step++) {
+		uint8_t row = random_below(BOARD_HEIGHT);
+		uint8_t col = random_below(BOARD_WIDTH);
+
+		if (field_is_revealed(g_generic[row][col])) {
+			continue;
+		}
+
+		if (random_below(3) == 0) {
+			field_toggle(&g_generic[row][col], FIELD_FLAGGED);
+			field_toggle(&g_fixed[row][col], FIELD_FLAGGED);
+			continue;
+		}
+
+		// Mines are left alone, so the game goes on.
+		if (field_is_mine(g_generic[row][col])) {
+			continue;
+		}
+
+		uint16_t generic_revealed = 0;
+		uint16_t generic_removed = 0;
+		uint16_t fixed_revealed = 0;
+		uint16_t fixed_removed = 0;
+
+		memset(g_generic_changes, 0, sizeof(g_generic_changes));
+		memset(g_fixed_changes, 0, sizeof(g_fixed_changes));
+
+		reveal_section(
+			&generic_revealed, &generic_removed, row, col,
+			BOARD_WIDTH, BOARD_HEIGHT, g_generic, g_generic_changes
+		);
+		fixed_reveal_section(
+			&fixed_revealed, &fixed_removed, row, col,
+			g_fixed, g_fixed_changes
+		);
+
+		if (
+			generic_revealed != fixed_revealed
+			|| generic_removed != fixed_removed
+			|| memcmp(g_generic, g_fixed, sizeof(g_fixed))
+			|| memcmp(
+				g_generic_changes, g_fixed_changes, sizeof(g_fixed_changes)
+			)
+		) {
+			printf(
+				"seed %u: engines differ revealing %u,%u\n",
+				seed, row, col
+			);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned games = argc > 1 ? (unsigned) atoi(argv[1]) : DEFAULT_GAMES;
+
+	if (games == 0) {
+		fprintf(stderr, "usage: %s [games]\n", argv[0]);
+		return 1;
+	}
+
+	for (unsigned seed = 1; seed <= games; seed++) {
+		if (play_game(seed)) {
+			return 1;
+		}
+	}
+
+	printf("%u games on %ux%u boards\n", games, BOARD_WIDTH, BOARD_HEIGHT);
+
+	return 0;
+}
@@ -0,0 +1,13 @@
+/**
+ * Stand-in for avr/interrupt.h. Interruptions never run on the host,
+ * so ISRs are plain functions.
+ */
+
+#ifndef MINES_HOST_INTERRUPT
+#define MINES_HOST_INTERRUPT
+
+#define ISR(vector) void vector(void)
+#define cli()
+#define sei()
+
+#endif
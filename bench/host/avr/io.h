@@ -0,0 +1,33 @@
+/**
+ * Stand-in for avr/io.h, so the display library and the renderer
+ * build on the host for the checks. Registers are plain variables,
+ * defined by bench/lcd_host.c.
+ */
+
+#ifndef MINES_HOST_IO
+#define MINES_HOST_IO
+
+#include <stdint.h>
+
+extern volatile uint8_t PORTB, DDRB;
+extern volatile uint8_t SPCR, SPSR, SPDR;
+extern volatile uint8_t TCCR2A, TCCR2B, OCR2A, TCNT2, TIMSK2;
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+
+#define SPE 6
+#define MSTR 4
+#define SPIE 7
+#define SPIF 7
+#define SPI2X 0
+#define WGM21 1
+#define CS20 0
+#define CS21 1
+#define OCIE2A 1
+
+#endif
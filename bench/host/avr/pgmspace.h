@@ -0,0 +1,19 @@
+/**
+ * Stand-in for avr/pgmspace.h. The host has a single address space,
+ * so program memory is read like any other.
+ */
+
+#ifndef MINES_HOST_PGMSPACE
+#define MINES_HOST_PGMSPACE
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(str) (str)
+#define pgm_read_byte(addr) (*(const uint8_t *) (addr))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+
+#endif
@@ -0,0 +1,11 @@
+/**
+ * Stand-in for util/delay.h. Nothing is waited for on the host.
+ */
+
+#ifndef MINES_HOST_DELAY
+#define MINES_HOST_DELAY
+
+#define _delay_ms(ms)
+#define _delay_us(us)
+
+#endif
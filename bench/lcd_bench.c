@@ -0,0 +1,108 @@
+/**
+ * AVR benchmark for the Nokia 5110 LCD driver.
+ *
+ * Times full framebuffer pushes and 70-cell board draws with Timer1
+ * and reports the average amount of CPU cycles taken over USART.
+ * Build it with and without LCD_SPI to compare both transports,
+ * and with LCD_FRAMEBUFFER to compare it to the cell renderer.
+ */
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+#include <stdint.h>
+
+#include "nokia5110.h"
+#include "usart.h"
+
+#define RENDERS 16
+#define DRAWS 16
+// Same dimensions as the game board.
+#define BOARD_WIDTH 14
+#define BOARD_HEIGHT 5
+// Timer1 runs at F_CPU / 8, so every tick is 8 cycles.
+#define CYCLES_PER_TICK 8
+
+/**
+ * Draw a board worth of characters and time it.
+ *
+ * @y_offset: vertical offset of every row from a bank boundary
+ *
+ * @return: the average amount of cycles per draw
+ */
+static uint32_t time_board_draw(uint8_t y_offset)
+{
+	uint32_t ticks = 0;
+
+	for (uint8_t i = 0; i < DRAWS; i++) {
+		// Alternate between characters so every cell changes.
+		char code = i & 1 ? '8' : '#';
+
+		TCNT1 = 0;
+
+		for (uint8_t row = 0; row < BOARD_HEIGHT; row++) {
+			nokia_lcd_set_cursor(0, row * 8 + y_offset);
+
+			for (uint8_t col = 0; col < BOARD_WIDTH; col++) {
+				nokia_lcd_write_char(code, 1);
+			}
+		}
+
+		ticks += TCNT1;
+	}
+
+	return ticks * CYCLES_PER_TICK / DRAWS;
+}
+
+int main()
+{
+	uint32_t ticks = 0;
+
+	USART_Init();
+	nokia_lcd_init();
+	// USART sends from its interruptions.
+	sei();
+
+	TCCR1A = 0;
+	TCCR1B = (1 << CS11);
+
+	for (uint8_t i = 0; i < RENDERS; i++) {
+		// Clearing marks the whole screen as changed,
+		// so every render pushes all 504 bytes.
+		nokia_lcd_clear();
+		nokia_lcd_write_string("AVR Mines", 1);
+
+		TCNT1 = 0;
+		nokia_lcd_render();
+		ticks += TCNT1;
+	}
+
+	// Time the draws before printing, so USART does not interrupt them.
+	uint32_t render = ticks * CYCLES_PER_TICK / RENDERS;
+	uint32_t aligned = time_board_draw(0);
+#ifdef LCD_FRAMEBUFFER
+	// Text snaps to the cells without a framebuffer.
+	uint32_t unaligned = time_board_draw(1);
+#endif
+
+#ifdef LCD_SPI
+	USART_puts("transport: spi\r\n");
+#else
+	USART_puts("transport: software\r\n");
+#endif
+#ifdef LCD_FRAMEBUFFER
+	USART_puts("renderer: framebuffer\r\n");
+#else
+	USART_puts("renderer: cells\r\n");
+#endif
+	USART_printf_P(PSTR("render: %lu cycles\r\n"), render);
+	USART_flush();
+	USART_printf_P(PSTR("aligned draw: %lu cycles\r\n"), aligned);
+	USART_flush();
+#ifdef LCD_FRAMEBUFFER
+	USART_printf_P(PSTR("unaligned draw: %lu cycles\r\n"), unaligned);
+	USART_flush();
+#endif
+
+	while (1);
+}
@@ -0,0 +1,46 @@
+/**
+ * The display library is included rather than linked, to reach
+ * the transfer an asynchronous render streams from its ISR.
+ */
+#include "nokia5110.c"
+
+#include "lcd_host.h"
+
+volatile uint8_t PORTB, DDRB;
+volatile uint8_t SPCR, SPSR, SPDR;
+volatile uint8_t TCCR2A, TCCR2B, OCR2A, TCNT2, TIMSK2;
+
+uint16_t lcd_host_render(uint8_t ram[LCD_HOST_BANKS][LCD_HOST_COLUMNS])
+{
+	// The address of the display persists between renders.
+	static uint8_t x = 0;
+	static uint8_t bank = 0;
+	uint16_t sent = 0;
+	uint8_t byte;
+	uint8_t is_data;
+
+	transfer_setup();
+
+	while (transfer_next(&byte, &is_data)) {
+		if (!is_data) {
+			if (byte & 0x80) {
+				x = byte & 0x7F;
+			} else if (byte & 0x40) {
+				bank = byte & 0x07;
+			}
+
+			continue;
+		}
+
+		ram[bank][x] = byte;
+		sent++;
+
+		// The address increments horizontally, wrapping to the next bank.
+		if (++x == LCD_HOST_COLUMNS) {
+			x = 0;
+			bank = (bank + 1) % LCD_HOST_BANKS;
+		}
+	}
+
+	return sent;
+}
@@ -0,0 +1,28 @@
+/**
+ * Emulated Nokia 5110 display for the host checks.
+ *
+ * The display library is built into bench/lcd_host.c, which decodes
+ * the bytes a render would send into the RAM of the display,
+ * so renders built in different ways can be compared.
+ */
+
+#ifndef MINES_LCD_HOST
+#define MINES_LCD_HOST
+
+#include <stdint.h>
+
+// Banks of 8 pixels and columns of the display's RAM.
+#define LCD_HOST_BANKS 6
+#define LCD_HOST_COLUMNS 84
+
+/**
+ * Send what changed since the last render to the emulated display,
+ * as the display's interruptions would.
+ *
+ * @ram: the RAM of the display, updated with the bytes sent
+ *
+ * @return: the amount of data bytes sent
+ */
+uint16_t lcd_host_render(uint8_t ram[LCD_HOST_BANKS][LCD_HOST_COLUMNS]);
+
+#endif
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+Decoder for the frame profiler reports of AVR Mines.
+
+Reads the USART output of a `make PROFILE=1` build and prints the
+statistics of every report found. The stream may be a capture file
+or a serial device set up beforehand, for instance with
+`stty -F /dev/ttyUSB0 57600 raw`.
+
+Usage: profile_decode.py [capture]
+"""
+
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+VERSION = 1
+BUCKETS = 8
+BUCKET_SHIFT = 9
+
+# Must match ProfileStage in src/profile.h.
+# "boards tried" counts boards rather than cycles.
+STAGES = [
+    "clear",
+    "board",
+    "status",
+    "render",
+    "input",
+    "reveal",
+    "hint",
+    "generate",
+    "boards tried",
+    "isr buttons",
+    "isr repeat",
+    "isr clock",
+    "isr lcd",
+]
+
+HEADER = struct.Struct("<BBH")
+STAGE = struct.Struct("<HIII%dH" % BUCKETS)
+
+
+def bucket_labels():
+    labels = ["<%d" % (1 << BUCKET_SHIFT)]
+
+    for bucket in range(1, BUCKETS - 1):
+        labels.append("<%d" % (1 << (BUCKET_SHIFT + bucket)))
+
+    labels.append(">=%d" % (1 << (BUCKET_SHIFT + BUCKETS - 2)))
+    return labels
+
+
+def report_size(report):
+    """
+    Get the size of a report starting after its sync bytes,
+    from the stage count in its header.
+    Return None if the header is incomplete, or 0 if it is corrupted.
+    """
+    if len(report) < HEADER.size:
+        return None
+
+    version, stages, _ = HEADER.unpack_from(report)
+
+    if version != VERSION or not stages:
+        return 0
+
+    return HEADER.size + stages * STAGE.size + 1
+
+
+def decode(report, size):
+    """
+    Decode a complete report of the given size, starting after
+    its sync bytes. Return the frames and the statistics of every
+    stage, or None if the report is corrupted.
+    """
+    _, stages, frames = HEADER.unpack_from(report)
+
+    if sum(report[:size - 1]) & 0xFF != report[size - 1]:
+        return None
+
+    stats = [
+        STAGE.unpack_from(report, HEADER.size + stage * STAGE.size)
+        for stage in range(stages)
+    ]
+
+    return frames, stats
+
+
+def print_report(frames, stats):
+    print("%d frames" % frames)
+    print("%-12s %6s %8s %8s %8s  %s" % (
+        "stage", "count", "min", "avg", "max", " ".join(bucket_labels())
+    ))
+
+    for stage, (count, low, avg, high, *buckets) in enumerate(stats):
+        name = STAGES[stage] if stage < len(STAGES) else str(stage)
+        print("%-12s %6d %8d %8d %8d  %s" % (
+            name, count, low, avg, high, " ".join(map(str, buckets))
+        ))
+
+    print()
+
+
+def main():
+    stream = open(sys.argv[1], "rb") if len(sys.argv) > 1 else sys.stdin.buffer
+    data = b""
+
+    while True:
+        chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+
+        if not chunk:
+            break
+
+        data += chunk
+
+        while True:
+            start = data.find(SYNC)
+
+            if start < 0:
+                data = data[-1:]
+                break
+
+            report = data[start + len(SYNC):]
+            size = report_size(report)
+
+            # Wait for the rest of the report, as serial devices
+            # hand it over in chunks.
+            if size is None or (size and len(report) < size):
+                data = data[start:]
+                break
+
+            decoded = decode(report, size) if size else None
+
+            # The sync bytes were part of something else.
+            if decoded is None:
+                data = data[start + 1:]
+                continue
+
+            frames, stats = decoded
+            print_report(frames, stats)
+            data = data[start + len(SYNC) + size:]
+
+
+if __name__ == "__main__":
+    main()
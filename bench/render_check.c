@@ -0,0 +1,212 @@
+/**
+ * Host check of the renderers of AVR Mines.
+ *
+ * Plays scripted games on every preset through write_board and the
+ * status line, like the game's frames do, and renders each frame to
+ * the emulated display of bench/lcd_host.c. A hash of the display's
+ * RAM is printed for every frame, so builds of this check with
+ * different renderers must print the same lines:
+ *  - by default, the display only keeps the character of each cell;
+ *  - with LCD_FRAMEBUFFER, it keeps every pixel of the screen;
+ *  - with FULL_REDRAW, every field of the window is drawn each frame,
+ *    instead of only those logged as changed by the board engine.
+ *
+ * Usage: render_check [games]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "chars.h"
+#include "lcd_host.h"
+#include "nokia5110.h"
+#include "random.h"
+#include "writing.h"
+
+#define DEFAULT_GAMES 50
+// Actions taken per game at most, if it does not end before.
+#define STEPS 400
+#define STATUS_Y (SCREEN_ROWS * 8)
+#define MAX_WIDTH 30
+#define MAX_HEIGHT 16
+
+/**
+ * Represent the size of a board, matching the presets of the game.
+ */
+typedef struct size {
+	uint8_t width;
+	uint8_t height;
+	uint16_t mines;
+} Size;
+
+static const Size SIZES[] = {
+	{14, 5, 14}, {9, 9, 10}, {16, 16, 40}, {MAX_WIDTH, MAX_HEIGHT, 99}
+};
+
+#define SIZE_AMOUNT (sizeof(SIZES) / sizeof(SIZES[0]))
+
+static Field g_cells[MAX_HEIGHT * MAX_WIDTH];
+static BitRow g_changes[MAX_HEIGHT];
+static uint8_t g_ram[LCD_HOST_BANKS][LCD_HOST_COLUMNS];
+
+/**
+ * Hash the RAM of the display with FNV-1a.
+ */
+static uint32_t hash_ram()
+{
+	uint32_t hash = 2166136261u;
+
+	for (uint8_t bank = 0; bank < LCD_HOST_BANKS; bank++) {
+		for (uint8_t x = 0; x < LCD_HOST_COLUMNS; x++) {
+			hash = (hash ^ g_ram[bank][x]) * 16777619u;
+		}
+	}
+
+	return hash;
+}
+
+/**
+ * Draw a frame as the game does, render it and print its hash.
+ *
+ * @frame: the number of the frame, printed along with its hash
+ */
+static void draw_frame(
+	const Size *size, Field board[size->height][size->width],
+	uint8_t view_x, uint8_t view_y, uint8_t sel_x, uint8_t sel_y,
+	uint16_t flags, uint16_t step, unsigned long frame
+) {
+#ifdef FULL_REDRAW
+	memset(g_changes, 0xFF, sizeof(g_changes));
+#endif
+
+	write_board(
+		size->width, size->height, board, g_changes,
+		view_x, view_y, sel_x, sel_y, PLAYING
+	);
+	// The first frames show a board being generated, as in games
+	// without guessing, and the others mark boards which may need it.
+	if (step < 2) {
+		write_generating(0, STATUS_Y, step);
+	} else {
+		write_timer(0, STATUS_Y, step / 60, step % 60);
+		nokia_lcd_write_char(step % 3 ? ' ' : '?', 1);
+		write_flag_count(7 * 6, STATUS_Y, flags, size->mines);
+	}
+
+	lcd_host_render(g_ram);
+	printf("%lu %08lx\n", frame, (unsigned long) hash_ram());
+}
+
+/**
+ * Play a game with random moves, flags and reveals.
+ *
+ * @frame: the number of frames drawn is added to this pointer
+ */
+static void play_game(const Size *size, unsigned seed, unsigned long *frame)
+{
+	Field (*board)[size->width] = (Field (*)[size->width]) g_cells;
+	uint8_t sel_x = 0;
+	uint8_t sel_y = 0;
+	uint8_t view_x = 0;
+	uint8_t view_y = 0;
+	uint16_t flags = 0;
+
+	random_seed(seed);
+	reset_board(size->width, size->height, board, size->mines);
+	nokia_lcd_clear();
+	memset(g_changes, 0xFF, sizeof(g_changes));
+
+	for (uint16_t step = 0; step < STEPS; step++) {
+		draw_frame(
+			size, board, view_x, view_y, sel_x, sel_y,
+			flags, step, (*frame)++
+		);
+
+		unsigned action = random_below(10);
+
+		board_log_change(g_changes, sel_y, sel_x);
+
+		if (action < 4) {
+			int8_t amount = action & 1 ? 1 : -1;
+
+			if (action < 2) {
+				sel_x = move_wrapping(sel_x, amount, size->width);
+			} else {
+				sel_y = move_wrapping(sel_y, amount, size->height);
+			}
+		} else if (action == 4) {
+			sel_x = move_to_hidden(
+				sel_x, sel_y, 1, 0, size->width, size->height, board
+			);
+		} else if (action == 5) {
+			sel_y = move_to_hidden(
+				sel_x, sel_y, 0, 1, size->width, size->height, board
+			);
+		}
+
+		board_log_change(g_changes, sel_y, sel_x);
+
+		uint8_t new_x = view_follow(view_x, sel_x, size->width, SCREEN_COLUMNS);
+		uint8_t new_y = view_follow(view_y, sel_y, size->height, SCREEN_ROWS);
+
+		// Scrolling redraws the whole window, as in the game.
+		if (new_x != view_x || new_y != view_y) {
+			view_x = new_x;
+			view_y = new_y;
+			memset(g_changes, 0xFF, sizeof(g_changes));
+		}
+
+		Field *field = &board[sel_y][sel_x];
+
+		if (field_is_revealed(*field)) {
+			continue;
+		}
+
+		if (action == 6) {
+			field_toggle(field, FIELD_FLAGGED);
+			flags = field_is_flagged(*field) ? flags + 1 : flags - 1;
+		} else if (action > 6) {
+			// Mines are left alone, so the game goes on.
+			if (field_is_mine(*field)) {
+				continue;
+			}
+
+			uint16_t fields_revealed = 0;
+			uint16_t flags_removed = 0;
+
+			reveal_section(
+				&fields_revealed, &flags_removed, sel_y, sel_x,
+				size->width, size->height, board, g_changes
+			);
+			flags -= flags_removed;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	unsigned games = argc > 1 ? (unsigned) atoi(argv[1]) : DEFAULT_GAMES;
+	unsigned long frame = 0;
+
+	if (games == 0) {
+		fprintf(stderr, "usage: %s [games]\n", argv[0]);
+		return 1;
+	}
+
+	nokia_lcd_custom_P(1, CLOCK_GLYPH);
+	nokia_lcd_custom_P(2, UNREVEALED_GLYPH);
+	nokia_lcd_custom_P(3, SELECTED_GLYPH);
+	nokia_lcd_custom_P(4, FLAG_GLYPH);
+	nokia_lcd_custom_P(5, MINE_GLYPH);
+
+	for (unsigned i = 0; i < SIZE_AMOUNT; i++) {
+		for (unsigned seed = 1; seed <= games; seed++) {
+			play_game(&SIZES[i], seed, &frame);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,449 @@
+/**
+ * Headless simulator benchmark for the AVR Mines firmware.
+ *
+ * Runs a firmware built with PROFILE in simavr, pressing the buttons
+ * on PD1-PD7 from a fixed script. The bytes sent to the LCD and over
+ * USART are captured, the profiler reports in the USART output are
+ * decoded, and the cycles taken per frame stage, per reveal and per
+ * render are reported.
+ *
+ * Expert, Intermediate and Classic games are played in turn,
+ * so the stages are profiled on boards of every size shown.
+ *
+ * Every budget given as stage=cycles is compared to the worst case
+ * of that stage, and the benchmark fails if any of them is exceeded.
+ *
+ * Usage: sim_bench firmware.elf [stage=cycles...]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_spi.h>
+#include <simavr/avr_uart.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+
+#include "profile.h"
+
+#define MCU "atmega328p"
+#define FREQUENCY 16000000
+
+// Buttons, as wired to PORTD.
+#define UP (1 << 1)
+#define LEFT (1 << 2)
+#define DOWN (1 << 3)
+#define RIGHT (1 << 4)
+#define FLAG (1 << 6)
+#define CHECK (1 << 7)
+
+// LCD pins on PORTB. The software transport puts DC on PB3, while
+// SPI uses it for MOSI and moves DC to PB0.
+#define LCD_SPI_DC 0
+#define LCD_DC 3
+#define LCD_DIN 4
+#define LCD_CLK 5
+
+// Must match ProfileStage in src/profile.h.
+// "boards tried" counts boards rather than cycles.
+static const char *STAGE_NAMES[PROFILE_STAGES] = {
+	"clear", "board", "status", "render", "input", "reveal",
+	"hint", "generate", "boards tried", "isr buttons", "isr repeat",
+	"isr clock", "isr lcd"
+};
+
+// Released until the firmware sleeps, once it has nothing left to do,
+// such as carrying on with a hint or generating a board.
+#define IDLE UINT16_MAX
+// Time waited for the firmware to sleep at most, in milliseconds.
+#define IDLE_LIMIT_MS 120000
+
+/**
+ * A scripted button press.
+ */
+typedef struct step {
+	uint8_t buttons;
+	// Time the buttons are held, then released, in milliseconds,
+	// or IDLE to release them until the firmware sleeps.
+	uint16_t hold_ms;
+	uint16_t release_ms;
+} Step;
+
+// Follow hints, revealing the fields they select, until a mine
+// is hinted and revealed, so the game always ends, even if
+// it was already over. Boards without guessing always give hints.
+#define END_GAME \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}, \
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30}
+
+static const Step SCRIPT[] = {
+	// Generate boards without guessing, starting with an Expert one,
+	// selected by wrapping around the presets. Generation carries on
+	// over frames, so the first field is revealed once it is done.
+	{UP, 30, 30},
+	{LEFT, 30, 30},
+	{CHECK, 30, 30},
+	{CHECK, 30, IDLE},
+	{RIGHT, 1200, 30},
+	{DOWN, 800, 30},
+	{CHECK, 30, 30},
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30},
+	// Go back to the menu and play an Intermediate game likewise.
+	END_GAME,
+	{FLAG, 30, 30},
+	{LEFT, 30, 30},
+	{CHECK, 30, 30},
+	{CHECK, 30, IDLE},
+	{RIGHT, 1200, 30},
+	{DOWN, 800, 30},
+	{CHECK, 30, 30},
+	{UP | DOWN, 30, IDLE}, {CHECK, 30, 30},
+	// Go back to the menu and start a Classic game,
+	// then reveal a few fields.
+	END_GAME,
+	{FLAG, 30, 30},
+	{LEFT, 30, 30}, {LEFT, 30, 30},
+	{CHECK, 30, 30},
+	{CHECK, 30, IDLE},
+	{RIGHT, 30, 30}, {RIGHT, 30, 30}, {DOWN, 30, 30},
+	{CHECK, 30, 30},
+	{FLAG, 30, 30}, {FLAG, 30, 30},
+	// Hold directions long enough to repeat.
+	{RIGHT, 1200, 30},
+	{CHECK, 30, 30},
+	{DOWN, 800, 30},
+	{CHECK, 30, 30},
+	{LEFT, 1200, 30},
+	{CHECK, 30, 30},
+	{UP, 30, 30}, {CHECK, 30, 30},
+	{RIGHT, 30, 30}, {CHECK, 30, 30},
+	{DOWN, 30, 30}, {CHECK, 30, 30},
+	{LEFT, 30, 30}, {FLAG, 30, 30},
+	// Ask for hints with the chord of both vertical directions.
+	{UP | DOWN, 30, 30}, {UP | DOWN, 30, 30},
+	// Leave a possible end screen and play again.
+	{FLAG, 30, 30},
+	{CHECK, 30, 30},
+	{CHECK, 30, 30},
+	{LEFT, 600, 30}, {CHECK, 30, 30},
+	{UP, 600, 30}, {CHECK, 30, 1500},
+};
+
+typedef struct stage_total {
+	uint32_t count;
+	uint64_t total;
+	uint32_t max;
+} StageTotal;
+
+static avr_t *g_avr;
+
+static uint8_t g_usart[1 << 16];
+static size_t g_usart_length = 0;
+
+// Last level of each PORTB pin.
+static uint8_t g_portb = 0;
+static uint8_t g_lcd_byte = 0;
+static uint8_t g_lcd_bits = 0;
+static unsigned long g_lcd_data = 0;
+static unsigned long g_lcd_commands = 0;
+// Column and bank address commands mark the start of a span.
+static unsigned long g_lcd_spans = 0;
+
+static void on_usart(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	if (g_usart_length < sizeof(g_usart)) {
+		g_usart[g_usart_length++] = value;
+	}
+}
+
+static void on_lcd_byte(uint8_t byte, uint8_t is_data)
+{
+	if (is_data) {
+		g_lcd_data++;
+	} else {
+		g_lcd_commands++;
+		g_lcd_spans += (byte & 0xC0) == 0x40;
+	}
+}
+
+static void on_pin(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	uint8_t pin = (intptr_t) param;
+
+	g_portb = (g_portb & ~(1 << pin)) | (!!value << pin);
+
+	// Data is sampled on the rising edge of the clock.
+	if (pin != LCD_CLK || !value) {
+		return;
+	}
+
+	g_lcd_byte = (g_lcd_byte << 1) | ((g_portb >> LCD_DIN) & 1);
+
+	if (++g_lcd_bits == 8) {
+		on_lcd_byte(g_lcd_byte, (g_portb >> LCD_DC) & 1);
+		g_lcd_bits = 0;
+	}
+}
+
+static void on_spi(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	on_lcd_byte(value, (g_portb >> LCD_SPI_DC) & 1);
+}
+
+static void run_ms(uint32_t ms)
+{
+	avr_cycle_count_t end = g_avr->cycle + (avr_cycle_count_t) ms * (FREQUENCY / 1000);
+
+	while (g_avr->cycle < end) {
+		int state = avr_run(g_avr);
+
+		if (state == cpu_Done || state == cpu_Crashed) {
+			fprintf(stderr, "firmware stopped at cycle %llu\n",
+				(unsigned long long) g_avr->cycle);
+			exit(1);
+		}
+	}
+}
+
+/**
+ * Run until the firmware sleeps, failing after IDLE_LIMIT_MS.
+ */
+static void run_until_idle()
+{
+	avr_cycle_count_t end = g_avr->cycle + (avr_cycle_count_t) IDLE_LIMIT_MS * (FREQUENCY / 1000);
+
+	while (g_avr->cycle < end) {
+		int state = avr_run(g_avr);
+
+		if (state == cpu_Sleeping) {
+			return;
+		}
+
+		if (state == cpu_Done || state == cpu_Crashed) {
+			fprintf(stderr, "firmware stopped at cycle %llu\n",
+				(unsigned long long) g_avr->cycle);
+			exit(1);
+		}
+	}
+
+	fprintf(stderr, "firmware still busy after %d ms\n", IDLE_LIMIT_MS);
+	exit(1);
+}
+
+static void set_buttons(uint8_t buttons)
+{
+	for (uint8_t pin = 0; pin < 8; pin++) {
+		avr_raise_irq(
+			avr_io_getirq(g_avr, AVR_IOCTL_IOPORT_GETIRQ('D'), pin),
+			(buttons >> pin) & 1
+		);
+	}
+}
+
+static uint32_t read_le(const uint8_t *pos, uint8_t size)
+{
+	uint32_t value = 0;
+
+	while (size--) {
+		value = (value << 8) | pos[size];
+	}
+
+	return value;
+}
+
+/**
+ * Decode every profiler report in the USART output.
+ *
+ * @return: the amount of frames reported
+ */
+static unsigned long decode_reports(StageTotal totals[PROFILE_STAGES])
+{
+	const size_t stage_size = 14 + 2 * PROFILE_BUCKETS;
+	const size_t report_size = 2 + 4 + PROFILE_STAGES * stage_size + 1;
+	unsigned long frames = 0;
+
+	for (size_t pos = 0; pos + report_size <= g_usart_length; pos++) {
+		const uint8_t *report = &g_usart[pos];
+		uint8_t checksum = 0;
+
+		if (
+			report[0] != PROFILE_SYNC_0 || report[1] != PROFILE_SYNC_1 ||
+			report[2] != PROFILE_VERSION || report[3] != PROFILE_STAGES
+		) {
+			continue;
+		}
+
+		for (size_t i = 2; i < report_size - 1; i++) {
+			checksum += report[i];
+		}
+
+		if (checksum != report[report_size - 1]) {
+			continue;
+		}
+
+		frames += read_le(report + 4, 2);
+
+		for (uint8_t stage = 0; stage < PROFILE_STAGES; stage++) {
+			const uint8_t *stats = report + 6 + stage * stage_size;
+			uint32_t count = read_le(stats, 2);
+			uint32_t avg = read_le(stats + 6, 4);
+			uint32_t max = read_le(stats + 10, 4);
+
+			totals[stage].count += count;
+			totals[stage].total += (uint64_t) avg * count;
+
+			if (max > totals[stage].max) {
+				totals[stage].max = max;
+			}
+		}
+
+		pos += report_size - 1;
+	}
+
+	return frames;
+}
+
+int main(int argc, char **argv)
+{
+	elf_firmware_t firmware = {0};
+	StageTotal totals[PROFILE_STAGES] = {{0}};
+	int failed = 0;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s firmware.elf [stage=cycles...]\n", argv[0]);
+		return 1;
+	}
+
+	if (elf_read_firmware(argv[1], &firmware)) {
+		fprintf(stderr, "could not read %s\n", argv[1]);
+		return 1;
+	}
+
+	g_avr = avr_make_mcu_by_name(MCU);
+
+	if (!g_avr) {
+		fprintf(stderr, "simavr does not support " MCU "\n");
+		return 1;
+	}
+
+	avr_init(g_avr);
+	avr_load_firmware(g_avr, &firmware);
+	g_avr->frequency = FREQUENCY;
+	g_avr->log = LOG_NONE;
+
+	// Capture USART instead of printing it.
+	uint32_t flags = 0;
+	avr_ioctl(g_avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+	flags &= ~AVR_UART_FLAG_STDIO;
+	avr_ioctl(g_avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+
+	avr_irq_register_notify(
+		avr_io_getirq(g_avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT),
+		on_usart, NULL
+	);
+
+	// Capture the LCD from either transport.
+	avr_irq_register_notify(
+		avr_io_getirq(g_avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_OUTPUT),
+		on_spi, NULL
+	);
+
+	const uint8_t pins[] = {LCD_SPI_DC, LCD_DC, LCD_DIN, LCD_CLK};
+
+	for (uint8_t i = 0; i < sizeof(pins); i++) {
+		avr_irq_register_notify(
+			avr_io_getirq(g_avr, AVR_IOCTL_IOPORT_GETIRQ('B'), pins[i]),
+			on_pin, (void *) (intptr_t) pins[i]
+		);
+	}
+
+	set_buttons(0);
+	// Let the LCD initialize.
+	run_ms(200);
+
+	for (size_t i = 0; i < sizeof(SCRIPT) / sizeof(SCRIPT[0]); i++) {
+		set_buttons(SCRIPT[i].buttons);
+		run_ms(SCRIPT[i].hold_ms);
+		set_buttons(0);
+
+		if (SCRIPT[i].release_ms == IDLE) {
+			run_until_idle();
+		} else {
+			run_ms(SCRIPT[i].release_ms);
+		}
+	}
+
+	unsigned long frames = decode_reports(totals);
+
+	printf("%s: %.2fs simulated, %lu frames profiled\n",
+		argv[1], (double) g_avr->cycle / FREQUENCY, frames);
+	printf("lcd: %lu data bytes, %lu commands, %lu spans\n",
+		g_lcd_data, g_lcd_commands, g_lcd_spans);
+
+	if (frames) {
+		printf("lcd data bytes per frame: %.1f\n", (double) g_lcd_data / frames);
+	}
+
+	printf("%-12s %8s %10s %10s\n", "stage", "count", "avg", "max");
+
+	for (uint8_t stage = 0; stage < PROFILE_STAGES; stage++) {
+		StageTotal *total = &totals[stage];
+
+		printf("%-12s %8lu %10.0f %10lu\n",
+			STAGE_NAMES[stage], (unsigned long) total->count,
+			total->count ? (double) total->total / total->count : 0.0,
+			(unsigned long) total->max);
+	}
+
+	if (!frames) {
+		fprintf(stderr, "no profiler report received, was PROFILE defined?\n");
+		return 1;
+	}
+
+	for (int arg = 2; arg < argc; arg++) {
+		char name[32];
+		unsigned long budget;
+		uint8_t stage;
+
+		if (sscanf(argv[arg], "%31[^=]=%lu", name, &budget) != 2) {
+			fprintf(stderr, "invalid budget: %s\n", argv[arg]);
+			return 1;
+		}
+
+		for (stage = 0; stage < PROFILE_STAGES; stage++) {
+			if (!strcmp(name, STAGE_NAMES[stage])) {
+				break;
+			}
+		}
+
+		if (stage == PROFILE_STAGES) {
+			fprintf(stderr, "unknown stage: %s\n", name);
+			return 1;
+		}
+
+		if (totals[stage].max > budget) {
+			fprintf(stderr, "%s: %lu cycles over the budget of %lu\n",
+				name, (unsigned long) totals[stage].max, budget);
+			failed = 1;
+		}
+	}
+
+	return failed;
+}
@@ -14,25 +14,76 @@
 #include "nokia5110.h"
 
 #include <avr/pgmspace.h>
+#include <avr/interrupt.h>
 #include <avr/io.h>
 #include <util/delay.h>
 #include <string.h>
 #include "nokia5110_chars.h"
 
 
+#ifndef LCD_FRAMEBUFFER
+/* Cells hold 5 glyph columns and a gap */
+#define CELL_WIDTH 6
+#define CELLS (84 / CELL_WIDTH)
+#endif
+
 static struct {
+#ifdef LCD_FRAMEBUFFER
     /* screen byte massive */
     uint8_t screen[504];
+#else
+    /* char of every cell, expanded from the glyph tables while sending */
+    char text[6][CELLS];
+#endif
 
-    /* cursor position */
+    /* cursor position, in cells without LCD_FRAMEBUFFER */
     uint8_t cursor_x;
     uint8_t cursor_y;
 
+#ifdef LCD_FRAMEBUFFER
+    /* columns changed since the last render, per bank: [start; end) */
+    uint8_t dirty_start[6];
+    uint8_t dirty_end[6];
+#else
+    /* cells changed since the last render, one bit per cell of each bank */
+    uint16_t dirty[6];
+#endif
+
 } nokia_lcd = {
     .cursor_x = 0,
     .cursor_y = 0
 };
 
+/* Steps taken to send a span of a bank */
+enum {
+	TRANSFER_X,
+	TRANSFER_Y,
+	TRANSFER_DATA
+};
+
+/*
+ * Framebuffer transfer, streamed by an ISR during asynchronous renders.
+ * A bank is locked from drawing until its span has been sent.
+ */
+static volatile struct {
+	uint8_t busy;
+	uint8_t bank;
+	uint8_t step;
+	uint8_t x;
+
+#ifdef LCD_FRAMEBUFFER
+	/* columns left to send, per bank: [start; end) */
+	uint8_t start[6];
+	uint8_t end[6];
+#else
+	uint8_t column;
+
+	/* cells left to send, per bank. Each run of
+	 * consecutive cells is sent from its own address */
+	uint16_t cells[6];
+#endif
+} transfer;
+
 /**
  * Sending data to LCD
  * @bytes: data
@@ -40,7 +91,9 @@ static struct {
  */
 static void write(uint8_t bytes, uint8_t is_data)
 {
+#ifndef LCD_SPI
 	register uint8_t i;
+#endif
 	/* Enable controller */
 	PORT_LCD &= ~(1 << LCD_SCE);
 
@@ -51,6 +104,11 @@ static void write(uint8_t bytes, uint8_t is_data)
 	else
 		PORT_LCD &= ~(1 << LCD_DC);
 
+#ifdef LCD_SPI
+	/* Send bytes and wait for the transfer to complete */
+	SPDR = bytes;
+	while (!(SPSR & (1 << SPIF)));
+#else
 	/* Send bytes */
 	for (i = 0; i < 8; i++) {
 		/* Set data pin to byte state */
@@ -63,6 +121,7 @@ static void write(uint8_t bytes, uint8_t is_data)
 		PORT_LCD |= (1 << LCD_CLK);
 		PORT_LCD &= ~(1 << LCD_CLK);
 	}
+#endif
 
 	/* Disable controller */
 	PORT_LCD |= (1 << LCD_SCE);
@@ -78,6 +137,221 @@ static void write_data(uint8_t data)
 	write(data, 1);
 }
 
+#ifndef LCD_FRAMEBUFFER
+/**
+ * Get a column of a cell
+ * @code: char code
+ * @column: column of the cell, the last one being the gap between chars
+ */
+static uint8_t cell_column(char code, uint8_t column)
+{
+	if (column >= 5)
+		return 0;
+	if (code >= ' ')
+		return pgm_read_byte(&CHARSET[code - ' '][column]) & 0x7F;
+	/* Unset custom glyphs are left blank, like a space */
+	if (CUSTOM[(int)code])
+		return pgm_read_byte(&CUSTOM[(int)code][column]) & 0x7F;
+	return 0;
+}
+#endif
+
+/**
+ * Wait until a bank is no longer being sent,
+ * so it is never sent while half drawn
+ * @bank: bank (row of 8 pixels)
+ */
+static void lock_bank(uint8_t bank)
+{
+#ifdef LCD_FRAMEBUFFER
+	while (transfer.start[bank] < transfer.end[bank]);
+#else
+	while (transfer.cells[bank]);
+#endif
+}
+
+/**
+ * Move the dirty spans into the transfer, which must not be busy
+ */
+static void transfer_setup(void)
+{
+	register uint8_t bank;
+
+	for (bank = 0; bank < 6; bank++) {
+#ifdef LCD_FRAMEBUFFER
+		transfer.start[bank] = nokia_lcd.dirty_start[bank];
+		transfer.end[bank] = nokia_lcd.dirty_end[bank];
+		nokia_lcd.dirty_start[bank] = 0;
+		nokia_lcd.dirty_end[bank] = 0;
+#else
+		transfer.cells[bank] = nokia_lcd.dirty[bank];
+		nokia_lcd.dirty[bank] = 0;
+#endif
+	}
+
+	transfer.bank = 0;
+	transfer.step = TRANSFER_X;
+}
+
+/**
+ * Get the next byte of the transfer
+ * @byte: the byte is returned in this pointer
+ * @is_data: transfer mode is returned in this pointer: 1 - data; 0 - command;
+ * @return: 0 once the transfer is over, 1 otherwise
+ */
+static uint8_t transfer_next(uint8_t *byte, uint8_t *is_data)
+{
+	register uint8_t bank = transfer.bank;
+
+#ifdef LCD_FRAMEBUFFER
+	while (bank < 6 && transfer.start[bank] >= transfer.end[bank])
+#else
+	while (bank < 6 && !transfer.cells[bank])
+#endif
+		bank++;
+	transfer.bank = bank;
+
+	if (bank >= 6)
+		return 0;
+
+	switch (transfer.step) {
+	case TRANSFER_X:
+		/* Set column to the start of the span */
+#ifdef LCD_FRAMEBUFFER
+		transfer.x = transfer.start[bank];
+		*byte = 0x80 | transfer.x;
+#else
+		transfer.x = 0;
+		while (!(transfer.cells[bank] & (1 << transfer.x)))
+			transfer.x++;
+		transfer.column = 0;
+		*byte = 0x80 | transfer.x * CELL_WIDTH;
+#endif
+		*is_data = 0;
+		transfer.step = TRANSFER_Y;
+		break;
+	case TRANSFER_Y:
+		*byte = 0x40 | bank;
+		*is_data = 0;
+		transfer.step = TRANSFER_DATA;
+		break;
+	default:
+		/* The address increments after each byte */
+		*is_data = 1;
+#ifdef LCD_FRAMEBUFFER
+		*byte = nokia_lcd.screen[bank*84+transfer.x];
+
+		if (++transfer.x >= transfer.end[bank]) {
+			/* Unlock the bank */
+			transfer.start[bank] = 0;
+			transfer.end[bank] = 0;
+			transfer.step = TRANSFER_X;
+		}
+#else
+		*byte = cell_column(nokia_lcd.text[bank][transfer.x], transfer.column);
+
+		if (++transfer.column == CELL_WIDTH) {
+			/* The bank is unlocked once its last cell is sent */
+			transfer.cells[bank] &= ~(1 << transfer.x);
+			transfer.column = 0;
+
+			/* Address the next run of cells */
+			if (!(transfer.cells[bank] & (1 << ++transfer.x)))
+				transfer.step = TRANSFER_X;
+		}
+#endif
+	}
+
+	return 1;
+}
+
+static void transfer_end(void)
+{
+#ifdef LCD_SPI
+	SPCR &= ~(1 << SPIE);
+	PORT_LCD |= (1 << LCD_SCE);
+#else
+	TIMSK2 &= ~(1 << OCIE2A);
+#endif
+	transfer.busy = 0;
+}
+
+#ifdef LCD_SPI
+/*
+ * Start sending the next byte of the transfer through SPI
+ */
+static void transfer_spi_next(void)
+{
+	uint8_t byte, is_data;
+
+	if (!transfer_next(&byte, &is_data)) {
+		transfer_end();
+		return;
+	}
+
+	if (is_data)
+		PORT_LCD |= (1 << LCD_DC);
+	else
+		PORT_LCD &= ~(1 << LCD_DC);
+	SPDR = byte;
+}
+
+/*
+ * Send the next byte once the previous one is out
+ */
+ISR(SPI_STC_vect)
+{
+	LCD_ISR_BEGIN();
+	transfer_spi_next();
+	LCD_ISR_END();
+}
+#else
+/*
+ * Bit-bang a few bytes on every tick
+ */
+ISR(TIMER2_COMPA_vect)
+{
+	register uint8_t i;
+	uint8_t byte, is_data;
+
+	LCD_ISR_BEGIN();
+
+	for (i = 0; i < LCD_ASYNC_BYTES; i++) {
+		if (!transfer_next(&byte, &is_data)) {
+			transfer_end();
+			break;
+		}
+
+		write(byte, is_data);
+	}
+
+	LCD_ISR_END();
+}
+#endif
+
+/**
+ * Mark a column of a bank as changed since the last render
+ * @bank: bank (row of 8 pixels)
+ * @x: column, or cell without LCD_FRAMEBUFFER
+ */
+static void mark_dirty(uint8_t bank, uint8_t x)
+{
+#ifndef LCD_FRAMEBUFFER
+	nokia_lcd.dirty[bank] |= 1 << x;
+#else
+	if (nokia_lcd.dirty_start[bank] >= nokia_lcd.dirty_end[bank]) {
+		nokia_lcd.dirty_start[bank] = x;
+		nokia_lcd.dirty_end[bank] = x + 1;
+		return;
+	}
+
+	if (x < nokia_lcd.dirty_start[bank])
+		nokia_lcd.dirty_start[bank] = x;
+	if (x >= nokia_lcd.dirty_end[bank])
+		nokia_lcd.dirty_end[bank] = x + 1;
+#endif
+}
+
 /*
  * Public functions
  */
@@ -92,6 +366,18 @@ void nokia_lcd_init(void)
 	DDR_LCD |= (1 << LCD_DIN);
 	DDR_LCD |= (1 << LCD_CLK);
 
+#ifdef LCD_SPI
+	/* SPI master, MSB first, mode 0. RST sits on SS, which stays
+	 * an output so the peripheral never drops out of master mode */
+	SPCR = (1 << SPE) | (1 << MSTR);
+	SPSR = LCD_SPI_2X ? (1 << SPI2X) : 0;
+#else
+	/* Tick for asynchronous renders: CTC, fosc/32 */
+	TCCR2A = (1 << WGM21);
+	TCCR2B = (1 << CS21) | (1 << CS20);
+	OCR2A = LCD_ASYNC_TICK - 1;
+#endif
+
 	/* Reset display */
 	PORT_LCD |= (1 << LCD_RST);
 	PORT_LCD |= (1 << LCD_SCE);
@@ -131,14 +417,27 @@ void nokia_lcd_init(void)
 
 void nokia_lcd_clear(void)
 {
-	/* Set column and row to 0 */
-	write_cmd(0x80);
-	write_cmd(0x40);
-	/*Cursor too */
+#ifndef LCD_FRAMEBUFFER
+	register uint8_t i;
+
+#endif
+	/* Wait for the screen to be sent. Nothing is sent here, as every
+	 * transfer sets the address of each span itself */
+	while (transfer.busy);
+	/* Set the cursor to 0 */
 	nokia_lcd.cursor_x = 0;
 	nokia_lcd.cursor_y = 0;
+#ifdef LCD_FRAMEBUFFER
 	/* Clear everything (504 bytes = 84cols * 48 rows / 8 bits) */
     memset(nokia_lcd.screen, 0, 504);
+	/* The whole screen has to be sent again */
+	memset(nokia_lcd.dirty_start, 0, sizeof(nokia_lcd.dirty_start));
+	memset(nokia_lcd.dirty_end, 84, sizeof(nokia_lcd.dirty_end));
+#else
+	memset(nokia_lcd.text, ' ', sizeof(nokia_lcd.text));
+	for (i = 0; i < 6; i++)
+		nokia_lcd.dirty[i] = (1 << CELLS) - 1;
+#endif
 }
 
 void nokia_lcd_power(uint8_t on)
@@ -146,13 +445,70 @@ void nokia_lcd_power(uint8_t on)
 	write_cmd(on ? 0x20 : 0x24);
 }
 
+#ifdef LCD_FRAMEBUFFER
+/**
+ * Replace some bits of a screen byte
+ * @bank: bank (row of 8 pixels)
+ * @x: column
+ * @mask: bits to replace
+ * @value: new bits, outside of mask are ignored
+ */
+static void write_byte(uint8_t bank, uint8_t x, uint8_t mask, uint8_t value)
+{
+	uint8_t *byte = &nokia_lcd.screen[bank*84+x];
+	uint8_t new;
+
+	lock_bank(bank);
+	new = (*byte & ~mask) | (value & mask);
+
+	/* Only send bytes which actually changed */
+	if (new != *byte) {
+		*byte = new;
+		mark_dirty(bank, x);
+	}
+}
+
+/**
+ * Draw a glyph column at any height and scale
+ * @x: horizontal position
+ * @bits: glyph column, lowest bit on top
+ * @scale: size of char
+ */
+static void write_column(uint8_t x, uint8_t bits, uint8_t scale)
+{
+	register uint8_t i;
+	uint8_t bank = nokia_lcd.cursor_y / 8;
+	uint8_t bit = 1 << (nokia_lcd.cursor_y % 8);
+	uint8_t mask = 0, value = 0;
+	/* Glyph row and how many times it was repeated, avoiding divisions */
+	uint8_t row = 1, repeat = 0;
+
+	for (i = 0; i < 7*scale && bank < 6; i++) {
+		mask |= bit;
+		if (bits & row)
+			value |= bit;
+
+		if (++repeat == scale) {
+			repeat = 0;
+			row <<= 1;
+		}
+
+		/* Write whole bytes instead of single pixels */
+		bit <<= 1;
+		if (!bit) {
+			write_byte(bank++, x, mask, value);
+			bit = 1;
+			mask = value = 0;
+		}
+	}
+
+	if (mask && bank < 6)
+		write_byte(bank, x, mask, value);
+}
+
 void nokia_lcd_set_pixel(uint8_t x, uint8_t y, uint8_t value)
 {
-	uint8_t *byte = &nokia_lcd.screen[y/8*84+x];
-	if (value)
-		*byte |= (1 << (y % 8));
-	else
-		*byte &= ~(1 << (y %8 ));
+	write_byte(y/8, x, 1 << (y % 8), value ? 0xFF : 0);
 }
 
 void nokia_lcd_write_char(char code, uint8_t scale)
@@ -163,26 +519,28 @@ void nokia_lcd_write_char(char code, uint8_t scale)
     const uint8_t *glyph;
     uint8_t pgm_buffer[5];
     if(code >= ' ') {
-       memcpy_P(pgm_buffer, &CHARSET[code - ' '], sizeof(pgm_buffer));
-       glyph = pgm_buffer;
+       glyph = CHARSET[code - ' '];
     }
     else {
-       // Custom glyphs, on the other hand, are stored in RAM...
+       // Custom glyphs are stored in flash as well...
        if (CUSTOM[(int)code]) {
           glyph = CUSTOM[(int)code];
        } else {
           // Default to a space character if unset...
-          memcpy_P(pgm_buffer, &CHARSET[0], sizeof(pgm_buffer));
-          glyph = pgm_buffer;
+          glyph = CHARSET[0];
        }
     }
-	for (x = 0; x < 5*scale; x++)
-		for (y = 0; y < 7*scale; y++)
-			//if (pgm_read_byte(&CHARSET[code-32][x/scale]) & (1 << y/scale))
-			if (glyph[x/scale] & (1 << y/scale))
-				nokia_lcd_set_pixel(nokia_lcd.cursor_x + x, nokia_lcd.cursor_y + y, 1);
-			else
-				nokia_lcd_set_pixel(nokia_lcd.cursor_x + x, nokia_lcd.cursor_y + y, 0);
+    memcpy_P(pgm_buffer, glyph, sizeof(pgm_buffer));
+    glyph = pgm_buffer;
+	if (scale == 1 && nokia_lcd.cursor_y % 8 == 0 && nokia_lcd.cursor_x <= 84 - 5) {
+		/* Bank aligned: copy the glyph columns straight to the screen */
+		y = nokia_lcd.cursor_y / 8;
+		for (x = 0; x < 5; x++)
+			write_byte(y, nokia_lcd.cursor_x + x, 0x7F, glyph[x]);
+	} else {
+		for (x = 0; x < 5*scale && nokia_lcd.cursor_x + x < 84; x++)
+			write_column(nokia_lcd.cursor_x + x, glyph[x/scale], scale);
+	}
 
 	nokia_lcd.cursor_x += 5*scale + 1;
 	if (nokia_lcd.cursor_x >= 84) {
@@ -194,8 +552,29 @@ void nokia_lcd_write_char(char code, uint8_t scale)
 		nokia_lcd.cursor_y = 0;
 	}
 }
+#else
+void nokia_lcd_write_char(char code, uint8_t scale)
+{
+	char *cell = &nokia_lcd.text[nokia_lcd.cursor_y][nokia_lcd.cursor_x];
+
+	if (code >= 0x80) return; // 7 bit ASCII only
+
+	/* Only cells which actually changed are sent */
+	lock_bank(nokia_lcd.cursor_y);
+	if (*cell != code) {
+		*cell = code;
+		mark_dirty(nokia_lcd.cursor_y, nokia_lcd.cursor_x);
+	}
+
+	if (++nokia_lcd.cursor_x >= CELLS) {
+		nokia_lcd.cursor_x = 0;
+		if (++nokia_lcd.cursor_y >= 6)
+			nokia_lcd.cursor_y = 0;
+	}
+}
+#endif
 
-void nokia_lcd_custom(char code, uint8_t* glyph)
+void nokia_lcd_custom_P(char code, const uint8_t *glyph)
 {
     // Check if valid (ASCII 0 to 31)
     if(code >= ' ') return;
@@ -208,20 +587,61 @@ void nokia_lcd_write_string(const char *str, uint8_t scale)
 		nokia_lcd_write_char(*str++, scale);
 }
 
+void nokia_lcd_write_string_P(const char *str, uint8_t scale)
+{
+	char code;
+
+	while((code = pgm_read_byte(str++)))
+		nokia_lcd_write_char(code, scale);
+}
+
 void nokia_lcd_set_cursor(uint8_t x, uint8_t y)
 {
+#ifdef LCD_FRAMEBUFFER
 	nokia_lcd.cursor_x = x;
 	nokia_lcd.cursor_y = y;
+#else
+	nokia_lcd.cursor_x = x / CELL_WIDTH;
+	nokia_lcd.cursor_y = y / 8;
+#endif
 }
 
 void nokia_lcd_render(void)
 {
-	register unsigned i;
-	/* Set column and row to 0 */
-	write_cmd(0x80);
-	write_cmd(0x40);
+	uint8_t byte, is_data;
 
-	/* Write screen to display */
-	for (i = 0; i < 504; i++)
-		write_data(nokia_lcd.screen[i]);
+	/* Let any asynchronous render finish first */
+	while (transfer.busy);
+
+	transfer_setup();
+
+	while (transfer_next(&byte, &is_data))
+		write(byte, is_data);
+}
+
+void nokia_lcd_render_begin(void)
+{
+	while (transfer.busy);
+
+	transfer_setup();
+	transfer.busy = 1;
+
+#ifdef LCD_SPI
+	/* Keep the controller enabled for the whole transfer
+	 * and send the first byte, the ISR sends the rest */
+	PORT_LCD &= ~(1 << LCD_SCE);
+	/* Drop the flag left by the last blocking write */
+	if (SPSR & (1 << SPIF))
+		(void) SPDR;
+	SPCR |= (1 << SPIE);
+	transfer_spi_next();
+#else
+	TCNT2 = 0;
+	TIMSK2 |= (1 << OCIE2A);
+#endif
+}
+
+uint8_t nokia_lcd_render_busy(void)
+{
+	return transfer.busy;
 }
@@ -25,12 +25,63 @@
 
 /*
  * LCD's pins
+ *
+ * Define LCD_SPI to send data through the hardware SPI peripheral
+ * instead of bit-banging it. DIN and CLK must then be wired to
+ * MOSI (PB3) and SCK (PB5), so DC moves to PB0.
  */
 #define LCD_SCE PB1
 #define LCD_RST PB2
+#define LCD_CLK PB5
+#ifdef LCD_SPI
+#define LCD_DC PB0
+#define LCD_DIN PB3
+#else
 #define LCD_DC PB3
 #define LCD_DIN PB4
-#define LCD_CLK PB5
+#endif
+
+/*
+ * SPI clock for LCD_SPI: 1 - fosc/2; 0 - fosc/4;
+ * The PCD8544 is only specified up to 4 MHz, clear this if
+ * the display is unreliable at 8 MHz.
+ */
+#ifndef LCD_SPI_2X
+#define LCD_SPI_2X 1
+#endif
+
+/*
+ * Without LCD_SPI, asynchronous renders bit-bang LCD_ASYNC_BYTES
+ * every LCD_ASYNC_TICK * 32 cycles from the Timer2 compare ISR.
+ */
+#ifndef LCD_ASYNC_BYTES
+#define LCD_ASYNC_BYTES 4
+#endif
+#ifndef LCD_ASYNC_TICK
+#define LCD_ASYNC_TICK 64
+#endif
+
+/*
+ * Without LCD_FRAMEBUFFER, only the char of each 6x8 cell is kept,
+ * taking 84 bytes of RAM instead of 504, and the glyphs are expanded
+ * while rendering. Text then snaps to the cells and is never scaled.
+ * Define LCD_FRAMEBUFFER to draw pixels and scaled or unaligned text.
+ */
+
+/*
+ * Define LCD_ISR_HOOKS to call nokia_lcd_isr_begin and nokia_lcd_isr_end
+ * around the work of the ISRs sending asynchronous renders, for instance
+ * to profile them. The application must then define both.
+ */
+#ifdef LCD_ISR_HOOKS
+void nokia_lcd_isr_begin(void);
+void nokia_lcd_isr_end(void);
+#define LCD_ISR_BEGIN() nokia_lcd_isr_begin()
+#define LCD_ISR_END() nokia_lcd_isr_end()
+#else
+#define LCD_ISR_BEGIN()
+#define LCD_ISR_END()
+#endif
 
 #define LCD_CONTRAST 0x40
 
@@ -40,7 +91,7 @@
 void nokia_lcd_init(void);
 
 /*
- * Clear screen
+ * Clear screen, the whole screen is sent on the next render
  */
 void nokia_lcd_clear(void);
 
@@ -51,6 +102,7 @@ void nokia_lcd_clear(void);
  */
 void nokia_lcd_power(uint8_t on);
 
+#ifdef LCD_FRAMEBUFFER
 /**
  * Set single pixel
  * @x: horizontal pozition
@@ -58,6 +110,7 @@ void nokia_lcd_power(uint8_t on);
  * @value: show/hide pixel
  */
 void nokia_lcd_set_pixel(uint8_t x, uint8_t y, uint8_t value);
+#endif
 
 /**
  * Draw single char with 1-6 scale
@@ -73,6 +126,13 @@ void nokia_lcd_write_char(char code, uint8_t scale);
  */
 void nokia_lcd_write_string(const char *str, uint8_t scale);
 
+/**
+ * Draw string stored in flash. Example: writeString_P(PSTR("abc"),3);
+ * @str: sending string, in program memory
+ * @scale: size of text
+ */
+void nokia_lcd_write_string_P(const char *str, uint8_t scale);
+
 /**
  * Set cursor position
  * @x: horizontal position
@@ -82,12 +142,28 @@ void nokia_lcd_set_cursor(uint8_t x, uint8_t y);
 
 /*
  * Render screen to display
+ * Only the columns of each bank changed since the last render are sent
  */
 void nokia_lcd_render(void);
 
+/*
+ * Start rendering screen to display in the background
+ * The transfer is driven by the SPI complete ISR, or by a Timer2 ISR
+ * without LCD_SPI, so interrupts must be enabled. Drawing to a bank
+ * waits until it has been sent, so a half drawn frame is never sent.
+ */
+void nokia_lcd_render_begin(void);
+
+/*
+ * Check whether a background render is in progress
+ * @return: 1 - in progress; 0 - done;
+ */
+uint8_t nokia_lcd_render_busy(void);
+
 /*
  * Define custom char (ASCII 0-31)
+ * @glyph: 5 columns, in program memory
  */
-void nokia_lcd_custom(char code, uint8_t* glyph);
+void nokia_lcd_custom_P(char code, const uint8_t *glyph);
 
 #endif
@@ -99,4 +99,5 @@ const uint8_t CHARSET[][5] PROGMEM = {
 	{ 0x00, 0x00, 0x00, 0x00, 0x00 } // 7f
 };
 
-uint8_t *CUSTOM[' '];
+/* Custom glyphs, in flash as well */
+const uint8_t *CUSTOM[' '];
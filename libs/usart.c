@@ -1,7 +1,23 @@
 #include "usart.h"
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include <stdio.h>
 #include <stdarg.h>
 
+static volatile struct {
+    uint8_t buffer[USART_TX_SIZE];
+    uint8_t head;
+    uint8_t tail;
+    uint16_t dropped;
+} tx;
+
+static volatile struct {
+    uint8_t buffer[USART_RX_SIZE];
+    uint8_t head;
+    uint8_t tail;
+    uint16_t dropped;
+} rx;
+
 void USART_Init(void)
 {
     // Seta taxa de transmissão/recepção (baud rate)
@@ -9,31 +25,109 @@ void USART_Init(void)
     UBRR0L = (uint8_t)USART_UBBR_VALUE;
     // Seta formato do frame de transmissão: 8 bits de dados, sem paridade, 1 stop bit
     UCSR0C = (0 << USBS0) | (3 << UCSZ00);
-    // Habilita receptor e transmissor
-    UCSR0B = (1 << RXEN0) | (1 << TXEN0);
+    // Habilita receptor, transmissor e a interrupção de recepção
+    UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+}
+
+// Transmite o próximo byte do buffer
+ISR(USART_UDRE_vect)
+{
+    if (tx.tail == tx.head) {
+        // Buffer vazio, desabilita a interrupção até o próximo byte
+        UCSR0B &= ~(1 << UDRIE0);
+        return;
+    }
+
+    UDR0 = tx.buffer[tx.tail];
+    tx.tail = (tx.tail + 1) & (USART_TX_SIZE - 1);
+}
+
+// Guarda o byte recebido no buffer
+ISR(USART_RX_vect)
+{
+    uint8_t data = UDR0;
+    uint8_t next = (rx.head + 1) & (USART_RX_SIZE - 1);
+
+    if (next == rx.tail) {
+        rx.dropped++;
+        return;
+    }
+
+    rx.buffer[rx.head] = data;
+    rx.head = next;
+}
+
+// Coloca um byte no buffer de transmissão, se houver espaço
+static uint8_t tx_push(uint8_t u8Data)
+{
+    uint8_t next = (tx.head + 1) & (USART_TX_SIZE - 1);
+
+    if (next == tx.tail)
+        return 0;
+
+    tx.buffer[tx.head] = u8Data;
+    tx.head = next;
+    // Habilita a interrupção para transmitir o byte
+    UCSR0B |= (1 << UDRIE0);
+    return 1;
 }
 
 void USART_SendByte(uint8_t u8Data)
 {
-    // Espera se um byte estiver sendo transmitido
-    while ((UCSR0A & (1 << UDRE0)) == 0)
+    // Espera se o buffer estiver cheio
+    while (!tx_push(u8Data))
         ;
-    // Transmite o byte
-    UDR0 = u8Data;
 }
 
 uint8_t USART_ReceiveByte(void)
 {
+    uint8_t data;
+
     // Espera até um byte ter sido recebido
-    while ((UCSR0A & (1 << RXC0)) == 0)
+    while (rx.tail == rx.head)
+        ;
+    data = rx.buffer[rx.tail];
+    rx.tail = (rx.tail + 1) & (USART_RX_SIZE - 1);
+    return data;
+}
+
+uint8_t USART_available(void)
+{
+    return (rx.head - rx.tail) & (USART_RX_SIZE - 1);
+}
+
+uint8_t USART_write(const uint8_t *data, uint8_t length)
+{
+    uint8_t i;
+
+    for (i = 0; i < length; i++) {
+        if (!tx_push(data[i])) {
+            tx.dropped += length - i;
+            break;
+        }
+    }
+    return i;
+}
+
+uint8_t USART_tx_free(void)
+{
+    return (tx.tail - tx.head - 1) & (USART_TX_SIZE - 1);
+}
+
+void USART_flush(void)
+{
+    // Espera o buffer esvaziar
+    while (tx.tail != tx.head || (UCSR0B & (1 << UDRIE0)))
         ;
-    return UDR0;
 }
 
 void USART_puts(const char *str)
 {
-    while (*str)
-        USART_SendByte(*str++);
+    while (*str) {
+        if (!tx_push(*str++)) {
+            tx.dropped++;
+        }
+    }
 }
 
 void USART_printf(const char *format, ...)
@@ -45,4 +139,36 @@ void USART_printf(const char *format, ...)
     vsnprintf(str, 40, format, arg);
     USART_puts(str);
     va_end(arg);
-}
\ No newline at end of file
+}
+
+void USART_printf_P(PGM_P format, ...)
+{
+    char str[40];
+    va_list arg;
+
+    va_start(arg, format);
+    vsnprintf_P(str, 40, format, arg);
+    USART_puts(str);
+    va_end(arg);
+}
+
+uint16_t USART_tx_dropped(void)
+{
+    uint16_t dropped;
+
+    // Lê os 16 bits sem ser interrompido
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        dropped = tx.dropped;
+    }
+    return dropped;
+}
+
+uint16_t USART_rx_dropped(void)
+{
+    uint16_t dropped;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        dropped = rx.dropped;
+    }
+    return dropped;
+}
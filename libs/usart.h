@@ -3,14 +3,38 @@
 
 #include <stdint.h>
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 
 // VALUE = F_FPU / (16 * BAUD) - 1
 #define USART_UBBR_VALUE (((unsigned long)F_CPU / (unsigned long)(16 * (unsigned long)USART_BAUD)) - 1)
 
+// Tamanho dos buffers circulares, devem ser potências de 2
+#ifndef USART_TX_SIZE
+#define USART_TX_SIZE 64
+#endif
+#ifndef USART_RX_SIZE
+#define USART_RX_SIZE 32
+#endif
+
 void USART_Init(void);
+// Bloqueia apenas enquanto o buffer de transmissão estiver cheio
 void USART_SendByte(uint8_t u8Data);
+// Bloqueia até um byte ser recebido
 uint8_t USART_ReceiveByte(void);
+// Quantidade de bytes recebidos ainda não lidos
+uint8_t USART_available(void);
+// Não bloqueia: retorna quantos bytes couberam no buffer
+uint8_t USART_write(const uint8_t *data, uint8_t length);
+// Espaço livre no buffer de transmissão
+uint8_t USART_tx_free(void);
+// Bloqueia até todos os bytes serem transmitidos
+void USART_flush(void);
 void USART_puts(const char *str);
 void USART_printf(const char *format, ...);
+// Como USART_printf, com o formato na memória de programa
+void USART_printf_P(PGM_P format, ...);
+// Bytes descartados por buffers cheios
+uint16_t USART_tx_dropped(void);
+uint16_t USART_rx_dropped(void);
 
-#endif
\ No newline at end of file
+#endif
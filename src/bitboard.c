@@ -0,0 +1,74 @@
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "board.h"
+
+/**
+ * Add a row of single bits to a number stored in bit planes,
+ * starting at the given plane and propagating the carry upwards.
+ */
+static void add_to_planes(BitRow planes[4], BitRow bits, uint8_t plane)
+{
+	for (; plane < 4 && bits; plane++) {
+		BitRow carry = planes[plane] & bits;
+		planes[plane] ^= bits;
+		bits = carry;
+	}
+}
+
+void bitboard_from_board(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width],
+	uint8_t bits, BitRow rows[board_height]
+) {
+	for (uint8_t row = 0; row < board_height; row++) {
+		BitRow mask = 0;
+
+		for (uint8_t col = board_width; col-- > 0;) {
+			mask = (mask << 1) | ((board[row][col] & bits) != 0);
+		}
+
+		rows[row] = mask;
+	}
+}
+
+void bitboard_count_neighbours(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width],
+	const BitRow mines[board_height]
+) {
+	for (uint8_t row = 0; row < board_height; row++) {
+		BitRow planes[4] = {0, 0, 0, 0};
+
+		for (uint8_t src = row ? row - 1 : 0; src <= row + 1; src++) {
+			if (src >= board_height) {
+				break;
+			}
+
+			// Sum each field with its left and right neighbours
+			// into two planes using a full adder.
+			BitRow left = mines[src] << 1;
+			BitRow center = mines[src];
+			BitRow right = mines[src] >> 1;
+			BitRow sum = left ^ center;
+
+			add_to_planes(planes, sum ^ right, 0);
+			add_to_planes(planes, (left & center) | (sum & right), 1);
+		}
+
+		// Shift the planes as we go instead of by the column,
+		// since the AVR can only shift one bit at a time.
+		for (uint8_t col = 0; col < board_width; col++) {
+			uint8_t count =
+				(planes[0] & 1) | (planes[1] & 1) << 1 |
+				(planes[2] & 1) << 2 | (planes[3] & 1) << 3;
+
+			field_clear(&board[row][col], FIELD_NUM_MINES);
+			field_set(&board[row][col], count);
+
+			for (uint8_t plane = 0; plane < 4; plane++) {
+				planes[plane] >>= 1;
+			}
+		}
+	}
+}
@@ -0,0 +1,57 @@
+/**
+ * Bitboard utilities for the AVR Mines game.
+ *
+ * A bitboard stores one bit per field, with every row of the board
+ * packed into a single BitRow. Bit n of a row maps to column n.
+ */
+
+#ifndef MINES_BITBOARD
+#define MINES_BITBOARD
+
+#include <stdint.h>
+
+#include "field.h"
+
+typedef uint32_t BitRow;
+
+// Boards handled by bitboards may not be wider than a BitRow.
+#define BITBOARD_MAX_WIDTH 32
+
+/**
+ * Get a row with the lowest @width bits set.
+ */
+static inline BitRow bitrow_mask(uint8_t width)
+{
+	return width >= BITBOARD_MAX_WIDTH ?
+		(BitRow) ~0 : ((BitRow) 1 << width) - 1;
+}
+
+/**
+ * Extract a bitboard of the fields with any of the given FIELD_* bits set.
+ *
+ * @bits: the FIELD_* bits to look for
+ * @rows: the bitboard will be returned in this array
+ */
+void bitboard_from_board(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width],
+	uint8_t bits, BitRow rows[board_height]
+);
+
+/**
+ * Count the neighbouring mines of every field at once
+ * and store them in the board, replacing the previous counts.
+ *
+ * The 3x3 neighbourhood of every field in a row is summed in parallel
+ * by adding shifted rows into four bit planes, one per bit of the count.
+ * As with increment_neighbours, a mine counts itself.
+ *
+ * @mines: a bitboard of the mines in the board
+ */
+void bitboard_count_neighbours(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width],
+	const BitRow mines[board_height]
+);
+
+#endif
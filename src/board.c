@@ -1,19 +1,21 @@
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "bitboard.h"
 #include "board.h"
-#include "usart.h"
+#include "board_internal.h"
+#include "random.h"
+
+// Random fields tried by clear_opening before scanning for a free one.
+#define OPENING_TRIES 16
 
 void reset_board(
 	uint8_t board_width, uint8_t board_height,
 	Field board[board_height][board_width],
-	uint8_t mine_amount
+	uint16_t mine_amount
 ) {
-	for (uint8_t row = 0; row < board_height; row++) {
-		for (uint8_t col = 0; col < board_width; col++) {
-			board[row][col] = (Field) {0, 0, 0, 0};
-		}
-	}
+	memset(board, 0, board_height * board_width * sizeof(Field));
 
 	generate_mines(board_width, board_height, board, mine_amount);
 }
@@ -24,7 +26,7 @@ void reveal_board(
 ) {
 	for (uint8_t row = 0; row < board_height; row++) {
 		for (uint8_t col = 0; col < board_width; col++) {
-			board[row][col].revealed = 1;
+			field_set(&board[row][col], FIELD_REVEALED);
 		}
 	}
 }
@@ -32,80 +34,113 @@ void reveal_board(
 void generate_mines(
 	uint8_t board_width, uint8_t board_height,
 	Field board[board_height][board_width],
-	uint8_t amount
+	uint16_t amount
 ) {
-	int mines_generated = 0;
-	int fields_left = board_height * board_width - 1;
+	uint16_t fields = (uint16_t) board_height * board_width;
+	BitRow mines[board_height];
 
-	for (uint8_t row = 0; row < board_height; row++) {
-		for (uint8_t col = 0; col < board_width; col++) {
-			float rand_res = (float) rand() / (float) RAND_MAX;
+	memset(mines, 0, sizeof(mines));
 
-			if (fields_left * rand_res < amount - mines_generated) {
-				board[row][col].mine = 1;
-				mines_generated++;
-
-				increment_neighbours(
-					board_width, board_height, board, row, col, 1
-				);
+	if (amount > fields) {
+		amount = fields;
+	}
 
-				if (mines_generated == amount) {
-					break;
-				}
-			}
+	// Pick a uniformly random set of fields with Floyd's algorithm,
+	// which takes a single random number per mine.
+	for (uint16_t last = fields - amount; last < fields; last++) {
+		uint16_t pos = random_below(last + 1);
+		uint8_t row = pos / board_width;
+		uint8_t col = pos % board_width;
 
-			fields_left--;
+		// If the field is taken, the newly allowed one is surely free.
+		if (mines[row] & ((BitRow) 1 << col)) {
+			row = last / board_width;
+			col = last % board_width;
 		}
 
-		if (mines_generated == amount) {
-			break;
-		}
+		field_set(&board[row][col], FIELD_MINE);
+		mines[row] |= (BitRow) 1 << col;
 	}
+
+	// Count every neighbour at once instead of once per mine.
+	bitboard_count_neighbours(board_width, board_height, board, mines);
+}
+
+/**
+ * Get the last row or column next to the given one,
+ * so neighbours are visited without checking every one of them.
+ *
+ * @limit: the height or width of the board
+ */
+static uint8_t last_neighbour(uint8_t center, uint8_t limit)
+{
+	return center + 1 < limit ? center + 1 : center;
 }
 
 void reveal_section(
-	uint8_t *fields_revealed, uint8_t *flags_removed,
+	uint16_t *fields_revealed, uint16_t *flags_removed,
 	uint8_t row_orig, uint8_t col_orig,
 	uint8_t board_width, uint8_t board_height,
-	Field board[board_height][board_width]
+	Field board[board_height][board_width],
+	BitRow changes[board_height]
 ) {
-	Field *field = &board[row_orig][col_orig];
-	field->revealed = 1;
-	(*fields_revealed)++;
+	// Empty fields whose neighbours are yet to be revealed.
+	// A field is only added once, when it is revealed,
+	// so the cascade is bounded by the size of the board.
+	BitRow frontier[board_height];
+	// Rows above this one have no fields in the frontier.
+	uint8_t first = row_orig;
 
-	if (field->flagged) {
-		field->flagged = 0;
-		(*flags_removed)++;
-	}
+	memset(frontier, 0, sizeof(frontier));
+	board_log_change(changes, row_orig, col_orig);
 
-	if (field->num_mines) {
+	if (!reveal_field(
+		&board[row_orig][col_orig], fields_revealed, flags_removed
+	)) {
 		return;
 	}
 
-	for (int8_t dy = -1; dy <= 1; dy++) {
-		for (int8_t dx = -1; dx <= 1; dx++) {
-			int8_t row = row_orig + dy;
-			int8_t col = col_orig + dx;
+	frontier[row_orig] = (BitRow) 1 << col_orig;
 
-			if (
-				row < 0 || row >= board_height ||
-				col < 0 || col >= board_width
-			) {
-				continue;
-			}
+	while (first < board_height) {
+		if (!frontier[first]) {
+			first++;
+			continue;
+		}
 
-			field = &board[row][col];
+		uint8_t row_center = first;
+		uint8_t col_center = 0;
 
-			if (field->revealed) {
-				continue;
-			}
+		while (!(frontier[row_center] & ((BitRow) 1 << col_center))) {
+			col_center++;
+		}
+
+		frontier[row_center] &= ~((BitRow) 1 << col_center);
 
-			field->revealed = 1;
-			(*fields_revealed)++;
+		uint8_t row_last = last_neighbour(row_center, board_height);
+		uint8_t col_first = col_center ? col_center - 1 : 0;
+		uint8_t col_last = last_neighbour(col_center, board_width);
 
-			if (field->flagged) {
-				field->flagged = 0;
-				(*flags_removed)++;
+		for (
+			uint8_t row = row_center ? row_center - 1 : 0;
+			row <= row_last; row++
+		) {
+			for (uint8_t col = col_first; col <= col_last; col++) {
+				Field *field = &board[row][col];
+
+				if (field_is_revealed(*field)) {
+					continue;
+				}
+
+				board_log_change(changes, row, col);
+
+				if (reveal_field(field, fields_revealed, flags_removed)) {
+					frontier[row] |= (BitRow) 1 << col;
+
+					if (row < first) {
+						first = row;
+					}
+				}
 			}
 		}
 	}
@@ -119,17 +154,17 @@ int move_mine(
 	Field *orig = &board[row_orig][col_orig];
 	Field *dest = &board[row_dest][col_dest];
 
-	if (!orig->mine || dest->mine) {
+	if (!field_is_mine(*orig) || field_is_mine(*dest)) {
 		return 0;
 	}
 
-	orig->mine = 0;
+	field_clear(orig, FIELD_MINE);
 
 	increment_neighbours(
 		board_width, board_height, board, row_orig, col_orig, -1
 	);
 
-	dest->mine = 1;
+	field_set(dest, FIELD_MINE);
 
 	increment_neighbours(
 		board_width, board_height, board, row_dest, col_dest, 1
@@ -138,22 +173,77 @@ int move_mine(
 	return 1;
 }
 
+/**
+ * Check whether a field is next to, or on, the given center.
+ */
+static uint8_t is_neighbour(
+	uint8_t row, uint8_t col, uint8_t row_center, uint8_t col_center
+) {
+	return row + 1 >= row_center && row <= row_center + 1 &&
+		col + 1 >= col_center && col <= col_center + 1;
+}
+
+uint8_t clear_opening(
+	uint8_t row_center, uint8_t col_center,
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width]
+) {
+	uint16_t fields = (uint16_t) board_height * board_width;
+	uint8_t row_last = last_neighbour(row_center, board_height);
+	uint8_t col_first = col_center ? col_center - 1 : 0;
+	uint8_t col_last = last_neighbour(col_center, board_width);
+	uint8_t moved = 0;
+
+	for (uint8_t row = row_center ? row_center - 1 : 0; row <= row_last; row++) {
+		for (uint8_t col = col_first; col <= col_last; col++) {
+			if (!field_is_mine(board[row][col])) {
+				continue;
+			}
+
+			// Random fields are tried first, which takes a few tries
+			// unless the board is nearly full. Fields are then scanned
+			// from the last one tried, so a free field is always found.
+			uint16_t pos = random_below(fields);
+
+			for (uint16_t tries = 0; tries < fields + OPENING_TRIES; tries++) {
+				uint8_t row_dest = pos / board_width;
+				uint8_t col_dest = pos % board_width;
+
+				if (
+					!field_is_mine(board[row_dest][col_dest]) &&
+					!is_neighbour(row_dest, col_dest, row_center, col_center)
+				) {
+					moved += move_mine(
+						row, col, row_dest, col_dest,
+						board_width, board_height, board
+					);
+					break;
+				}
+
+				if (tries < OPENING_TRIES) {
+					pos = random_below(fields);
+				} else {
+					pos = pos + 1 < fields ? pos + 1 : 0;
+				}
+			}
+		}
+	}
+
+	return moved;
+}
+
 void increment_neighbours(
 	uint8_t board_width, uint8_t board_height,
 	Field board[board_height][board_width],
 	uint8_t row_center, uint8_t col_center, int8_t increment
 ) {
-	for (int8_t dy = -1; dy <= 1; dy++) {
-		for (int8_t dx = -1; dx <= 1; dx++) {
-			int8_t row = row_center + dy;
-			int8_t col = col_center + dx;
-
-			if (
-				row >= 0 && row < board_height &&
-				col >= 0 && col < board_width
-			) {
-				board[row][col].num_mines += increment;
-			}
+	uint8_t row_last = last_neighbour(row_center, board_height);
+	uint8_t col_first = col_center ? col_center - 1 : 0;
+	uint8_t col_last = last_neighbour(col_center, board_width);
+
+	for (uint8_t row = row_center ? row_center - 1 : 0; row <= row_last; row++) {
+		for (uint8_t col = col_first; col <= col_last; col++) {
+			field_add_mines(&board[row][col], increment);
 		}
 	}
 }
@@ -166,3 +256,28 @@ int move_wrapping(uint8_t sel, int8_t amount, uint8_t limit) {
 	sel += amount;
 	return sel < limit ? sel : 0;
 }
+
+int move_to_hidden(
+	uint8_t sel_x, uint8_t sel_y, int8_t dx, int8_t dy,
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width]
+) {
+	uint8_t x = sel_x;
+	uint8_t y = sel_y;
+
+	do {
+		if (dx) {
+			x = move_wrapping(x, dx, board_width);
+		} else {
+			y = move_wrapping(y, dy, board_height);
+		}
+
+		Field field = board[y][x];
+
+		if (!field_is_revealed(field) && !field_is_flagged(field)) {
+			break;
+		}
+	} while (x != sel_x || y != sel_y);
+
+	return dx ? x : y;
+}
@@ -8,16 +8,18 @@
 
 #include <stdint.h>
 
+#include "bitboard.h"
+#include "field.h"
+
 /**
- * Represent a field in the board.
+ * Record a field as changed in a change log, which is a bitboard
+ * of the fields to redraw. Only the fields logged are redrawn
+ * by write_board, instead of the whole board.
  */
-typedef struct field {
-	uint8_t mine;
-	uint8_t flagged;
-	uint8_t revealed;
-	// Number of neighbouring mines.
-	uint8_t num_mines;
-} Field;
+static inline void board_log_change(BitRow changes[], uint8_t row, uint8_t col)
+{
+	changes[row] |= (BitRow) 1 << col;
+}
 
 /**
  * Represent a game state.
@@ -42,7 +44,7 @@ typedef enum state {
 void reset_board(
 	uint8_t board_width, uint8_t board_height,
 	Field board[board_height][board_width],
-	uint8_t mine_amount
+	uint16_t mine_amount
 );
 
 /**
@@ -55,15 +57,19 @@ void reveal_board(
 
 /**
  * Randomly distribute mines across the board.
+ * Mines are placed in a time proportional to their amount,
+ * using the sequence of random_next, so a board only depends
+ * on the seed given to random_seed.
+ *
+ * Every field may be picked, as the first field revealed
+ * is cleared of mines afterwards with clear_opening.
  *
- * The last field is always skipped in case the
- * first field revealed turns out to be a mine.
- * In that case, it may safely be moved to that corner.
+ * The board may not be wider than BITBOARD_MAX_WIDTH.
  */
 void generate_mines(
 	uint8_t board_width, uint8_t board_height,
 	Field board[board_height][board_width],
-	uint8_t amount
+	uint16_t amount
 );
 
 /**
@@ -71,6 +77,12 @@ void generate_mines(
  * In that case, reveal the origin field only.
  * It is assumed to be unrevealed and not a mine.
  *
+ * Revealing cascades through every connected field without
+ * neighbouring mines, as well as their borders.
+ * No recursion is used: pending fields are kept in a bitboard
+ * frontier of one BitRow per row, so the board may not be wider
+ * than BITBOARD_MAX_WIDTH.
+ *
  * @fields_revealed: the number of fields revealed during the
  *	execution of this function will be returned in this pointer
  * @flags_removed: the number of flags removed during the
@@ -78,12 +90,14 @@ void generate_mines(
  *	A flag is removed when its field is revealed
  * @row_orig: the origin row of this section
  * @col_orig: the origin column of this section
+ * @changes: every field revealed is logged in this change log
  */
 void reveal_section(
-	uint8_t *fields_revealed, uint8_t *flags_removed,
+	uint16_t *fields_revealed, uint16_t *flags_removed,
 	uint8_t row_orig, uint8_t col_orig,
 	uint8_t board_width, uint8_t board_height,
-	Field board[board_height][board_width]
+	Field board[board_height][board_width],
+	BitRow changes[board_height]
 );
 
 /**
@@ -100,6 +114,23 @@ int move_mine(
 	Field board[board_height][board_width]
 );
 
+/**
+ * Move the mines on a field and around it to random fields outside
+ * of its neighbourhood, so revealing it opens a section.
+ * Only the mines moved and their neighbours are updated,
+ * so this takes a time proportional to the amount of mines moved
+ * rather than to the size of the board.
+ *
+ * Mines are left in place if no free field is left outside.
+ *
+ * @return: the amount of mines moved
+ */
+uint8_t clear_opening(
+	uint8_t row_center, uint8_t col_center,
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width]
+);
+
 /**
  * Increment the number of neighbouring mines on the coordinates given.
  * This may be used when adding or removing a mine.
@@ -121,4 +152,21 @@ void increment_neighbours(
  */
 int move_wrapping(uint8_t sel, int8_t amount, uint8_t limit);
 
+/**
+ * Move the cursor one field at a time alongside the x or y axis,
+ * wrapping like move_wrapping, until it reaches a field which is
+ * neither revealed nor flagged.
+ *
+ * @dx: horizontal step, either -1, 0 or 1
+ * @dy: vertical step, either -1, 0 or 1, if dx is 0
+ *
+ * @return: the new position on the axis moved along,
+ *	which is unchanged if no such field is found
+ */
+int move_to_hidden(
+	uint8_t sel_x, uint8_t sel_y, int8_t dx, int8_t dy,
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width]
+);
+
 #endif
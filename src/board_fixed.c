@@ -0,0 +1,136 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "board.h"
+#include "board_internal.h"
+#include "board_fixed.h"
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+// The engine is also built for the host by `make bench`.
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *) (addr))
+#endif
+
+#if BOARD_WIDTH < 2 || BOARD_HEIGHT < 2 || BOARD_WIDTH > BITBOARD_MAX_WIDTH
+#error "BOARD_WIDTH must be within 2 and BITBOARD_MAX_WIDTH, BOARD_HEIGHT at least 2"
+#endif
+
+// Neighbours of a field as row and column steps, ended by 0, 0.
+#define END {0, 0}
+#define ABOVE {-1, -1}, {-1, 0}, {-1, 1}
+#define BELOW {1, -1}, {1, 0}, {1, 1}
+#define ABOVE_LEFT {-1, -1}, {-1, 0}
+#define ABOVE_RIGHT {-1, 0}, {-1, 1}
+#define BELOW_LEFT {1, -1}, {1, 0}
+#define BELOW_RIGHT {1, 0}, {1, 1}
+
+/**
+ * Neighbours of each kind of field, indexed by neighbours_of.
+ * Lists are padded with END to the longest one.
+ */
+static const int8_t NEIGHBOURS[9][9][2] PROGMEM = {
+	// First row: left corner, inner fields and right corner.
+	{{0, 1}, BELOW_RIGHT, END},
+	{{0, -1}, {0, 1}, BELOW, END},
+	{{0, -1}, BELOW_LEFT, END},
+	// Inner rows.
+	{ABOVE_RIGHT, {0, 1}, BELOW_RIGHT, END},
+	{ABOVE, {0, -1}, {0, 1}, BELOW, END},
+	{ABOVE_LEFT, {0, -1}, BELOW_LEFT, END},
+	// Last row.
+	{ABOVE_RIGHT, {0, 1}, END},
+	{ABOVE, {0, -1}, {0, 1}, END},
+	{ABOVE_LEFT, {0, -1}, END}
+};
+
+/**
+ * Get the neighbours of a field.
+ *
+ * @return: a list of row and column steps in program memory,
+ *	ended by a step of 0, 0
+ */
+static const int8_t (*neighbours_of(uint8_t row, uint8_t col))[2]
+{
+	uint8_t kind = 0;
+
+	if (row) {
+		kind = row == BOARD_HEIGHT - 1 ? 6 : 3;
+	}
+
+	if (col) {
+		kind += col == BOARD_WIDTH - 1 ? 2 : 1;
+	}
+
+	return NEIGHBOURS[kind];
+}
+
+void fixed_reveal_section(
+	uint16_t *fields_revealed, uint16_t *flags_removed,
+	uint8_t row_orig, uint8_t col_orig,
+	Field board[BOARD_HEIGHT][BOARD_WIDTH],
+	BitRow changes[BOARD_HEIGHT]
+) {
+	// Same cascade as reveal_section.
+	BitRow frontier[BOARD_HEIGHT];
+	uint8_t first = row_orig;
+
+	memset(frontier, 0, sizeof(frontier));
+	board_log_change(changes, row_orig, col_orig);
+
+	if (!reveal_field(
+		&board[row_orig][col_orig], fields_revealed, flags_removed
+	)) {
+		return;
+	}
+
+	frontier[row_orig] = (BitRow) 1 << col_orig;
+
+	while (first < BOARD_HEIGHT) {
+		if (!frontier[first]) {
+			first++;
+			continue;
+		}
+
+		uint8_t row_center = first;
+		uint8_t col_center = 0;
+
+		while (!(frontier[row_center] & ((BitRow) 1 << col_center))) {
+			col_center++;
+		}
+
+		frontier[row_center] &= ~((BitRow) 1 << col_center);
+
+		const int8_t (*step)[2] = neighbours_of(row_center, col_center);
+
+		// Only the end of the list is checked, never the borders.
+		for (;; step++) {
+			int8_t dy = pgm_read_byte(&(*step)[0]);
+			int8_t dx = pgm_read_byte(&(*step)[1]);
+
+			if (!dy && !dx) {
+				break;
+			}
+
+			uint8_t row = row_center + dy;
+			uint8_t col = col_center + dx;
+			Field *field = &board[row][col];
+
+			if (field_is_revealed(*field)) {
+				continue;
+			}
+
+			board_log_change(changes, row, col);
+
+			if (reveal_field(field, fields_revealed, flags_removed)) {
+				frontier[row] |= (BitRow) 1 << col;
+
+				if (row < first) {
+					first = row;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,38 @@
+/**
+ * Board engine specialised for a board size fixed at compile time,
+ * for the AVR Mines game.
+ *
+ * Neighbours are visited through precomputed tables instead of
+ * bounds checks, with one table for each kind of field: inner fields,
+ * fields on each border and fields on each corner. The generic
+ * functions in board.h remain for boards sized at runtime.
+ */
+
+#ifndef MINES_BOARD_FIXED
+#define MINES_BOARD_FIXED
+
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "board.h"
+
+// Specify the board's dimensions in lines and columns.
+// Both must be at least 2, and the width at most BITBOARD_MAX_WIDTH.
+#ifndef BOARD_WIDTH
+#define BOARD_WIDTH 14
+#endif
+#ifndef BOARD_HEIGHT
+#define BOARD_HEIGHT 5
+#endif
+
+/**
+ * Same as reveal_section, for a board of the fixed size.
+ */
+void fixed_reveal_section(
+	uint16_t *fields_revealed, uint16_t *flags_removed,
+	uint8_t row_orig, uint8_t col_orig,
+	Field board[BOARD_HEIGHT][BOARD_WIDTH],
+	BitRow changes[BOARD_HEIGHT]
+);
+
+#endif
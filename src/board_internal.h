@@ -0,0 +1,32 @@
+/**
+ * Helpers shared by the board engines of board.c and board_fixed.c,
+ * not meant for the rest of the AVR Mines game.
+ */
+
+#ifndef MINES_BOARD_INTERNAL
+#define MINES_BOARD_INTERNAL
+
+#include <stdint.h>
+
+#include "field.h"
+
+/**
+ * Reveal a single field, removing its flag if there is one.
+ *
+ * @return: 1 if the field has no neighbouring mines, 0 otherwise.
+ */
+static inline uint8_t reveal_field(
+	Field *field, uint16_t *fields_revealed, uint16_t *flags_removed
+) {
+	field_set(field, FIELD_REVEALED);
+	(*fields_revealed)++;
+
+	if (field_is_flagged(*field)) {
+		field_clear(field, FIELD_FLAGGED);
+		(*flags_removed)++;
+	}
+
+	return field_num_mines(*field) == 0;
+}
+
+#endif
@@ -1,13 +1,16 @@
 /**
- * Custom glyphs for the AVR Nokia game.
+ * Custom glyphs for the AVR Nokia game,
+ * registered with nokia_lcd_custom_P.
  */
 
 #ifndef MINES_CHARS
 #define MINES_CHARS
 
+#include <avr/pgmspace.h>
+
 #include <stdint.h>
 
-static const uint8_t CLOCK_GLYPH[] = {
+static const uint8_t CLOCK_GLYPH[] PROGMEM = {
 	0b0111110,
 	0b1100011,
 	0b1001101,
@@ -15,7 +18,7 @@ static const uint8_t CLOCK_GLYPH[] = {
 	0b0111110
 };
 
-static const uint8_t FLAG_GLYPH[] = {
+static const uint8_t FLAG_GLYPH[] PROGMEM = {
 	0b0000000,
 	0b1111111,
 	0b0011111,
@@ -23,7 +26,7 @@ static const uint8_t FLAG_GLYPH[] = {
 	0b0000100
 };
 
-static const uint8_t MINE_GLYPH[] = {
+static const uint8_t MINE_GLYPH[] PROGMEM = {
 	0b0101010,
 	0b0011100,
 	0b0111110,
@@ -31,7 +34,7 @@ static const uint8_t MINE_GLYPH[] = {
 	0b0101010
 };
 
-static const uint8_t UNREVEALED_GLYPH[] = {
+static const uint8_t UNREVEALED_GLYPH[] PROGMEM = {
 	0b0000000,
 	0b0011100,
 	0b0011100,
@@ -39,7 +42,7 @@ static const uint8_t UNREVEALED_GLYPH[] = {
 	0b0000000
 };
 
-static const uint8_t SELECTED_GLYPH[] = {
+static const uint8_t SELECTED_GLYPH[] PROGMEM = {
 	0b0111110,
 	0b0111110,
 	0b0111110,
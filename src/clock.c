@@ -0,0 +1,65 @@
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+#include <stdint.h>
+
+#include "clock.h"
+#include "profile.h"
+
+static volatile uint32_t g_millis = 0;
+
+void clock_init()
+{
+	// CTC mode without a prescaler.
+	TCCR1A = 0;
+	TCCR1B = (1 << WGM12) | (1 << CS10);
+	TCNT1 = 0;
+	OCR1A = CLOCK_CYCLES_PER_TICK - 1;
+	TIMSK1 |= (1 << OCIE1A);
+}
+
+uint32_t clock_millis()
+{
+	uint32_t millis;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		millis = g_millis;
+	}
+
+	return millis;
+}
+
+uint32_t clock_cycles()
+{
+	uint32_t millis;
+	uint16_t ticks;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		millis = g_millis;
+		ticks = TCNT1;
+
+		// The counter restarted, but its interruption is yet to run.
+		if ((TIFR1 & (1 << OCF1A)) && ticks < CLOCK_CYCLES_PER_TICK / 2) {
+			millis++;
+		}
+	}
+
+	return millis * CLOCK_CYCLES_PER_TICK + ticks;
+}
+
+ISR(TIMER1_COMPA_vect)
+{
+	static uint16_t ticks = 0;
+
+	PROFILE_BEGIN(start);
+	g_millis++;
+	clock_tick();
+
+	if (++ticks == CLOCK_FREQ) {
+		ticks = 0;
+		clock_second();
+	}
+
+	PROFILE_END(PROFILE_ISR_CLOCK, start);
+}
@@ -0,0 +1,47 @@
+/**
+ * System clock for the AVR Mines game.
+ *
+ * Timer1 counts every CPU cycle and interrupts once per millisecond,
+ * which gives both a time base for the game and cycle-accurate
+ * timestamps for profiling.
+ */
+
+#ifndef MINES_CLOCK
+#define MINES_CLOCK
+
+#include <stdint.h>
+
+// Clock interruptions per second.
+#define CLOCK_FREQ 1000
+#define CLOCK_CYCLES_PER_TICK (F_CPU / CLOCK_FREQ)
+
+/**
+ * Start the clock. Interruptions must be enabled for it to run.
+ */
+void clock_init();
+
+/**
+ * Get the milliseconds elapsed since the clock was started.
+ */
+uint32_t clock_millis();
+
+/**
+ * Get the CPU cycles elapsed since the clock was started.
+ * This wraps around every 2^32 cycles, about 268s at 16MHz,
+ * so only differences of timestamps are meaningful.
+ */
+uint32_t clock_cycles();
+
+/**
+ * Called from the clock interruption once per second.
+ * It must be defined by the application.
+ */
+void clock_second();
+
+/**
+ * Called from the clock interruption every millisecond, before
+ * clock_second. It must be defined by the application and kept short.
+ */
+void clock_tick();
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * Lock-free event queue
+ * for the AVR Mines game.
+ *
+ * Events are pushed from interruptions and popped by the main loop.
+ * Each side only writes its own single byte index, so no locking
+ * is needed as long as there is a single consumer.
+ * Interruptions do not nest, so several of them may push.
+ */
+
+#ifndef MINES_EVENTS
+#define MINES_EVENTS
+
+#include <stdint.h>
+
+// Must be a power of two.
+#define EVENT_QUEUE_SIZE 16
+
+typedef struct event_queue {
+	volatile uint8_t head;
+	volatile uint8_t tail;
+	volatile uint8_t events[EVENT_QUEUE_SIZE];
+	// Amount of events dropped because the queue was full.
+	volatile uint8_t dropped;
+} EventQueue;
+
+static inline uint8_t event_queue_empty(const EventQueue *queue)
+{
+	return queue->head == queue->tail;
+}
+
+/**
+ * Add an event to the queue.
+ *
+ * @return: 0 if the queue is full, 1 otherwise.
+ */
+static inline uint8_t event_push(EventQueue *queue, uint8_t event)
+{
+	uint8_t head = queue->head;
+	uint8_t next = (head + 1) & (EVENT_QUEUE_SIZE - 1);
+
+	if (next == queue->tail) {
+		queue->dropped++;
+		return 0;
+	}
+
+	queue->events[head] = event;
+	// Only publish the event once it is stored.
+	queue->head = next;
+
+	return 1;
+}
+
+/**
+ * Take the oldest event from the queue.
+ *
+ * @event: the event will be returned in this pointer
+ *
+ * @return: 0 if the queue is empty, 1 otherwise.
+ */
+static inline uint8_t event_pop(EventQueue *queue, uint8_t *event)
+{
+	uint8_t tail = queue->tail;
+
+	if (tail == queue->head) {
+		return 0;
+	}
+
+	*event = queue->events[tail];
+	queue->tail = (tail + 1) & (EVENT_QUEUE_SIZE - 1);
+
+	return 1;
+}
+
+#endif
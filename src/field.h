@@ -0,0 +1,79 @@
+/**
+ * Field storage for the AVR Mines game.
+ *
+ * Kept apart from board.h, so bitboards may read fields
+ * without depending on the board utilities.
+ */
+
+#ifndef MINES_FIELD
+#define MINES_FIELD
+
+#include <stdint.h>
+
+/**
+ * Represent a field in the board, packed into a single byte.
+ *
+ * The lower nibble holds the number of neighbouring mines,
+ * while the upper bits hold the FIELD_* state bits below.
+ * Fields should only be accessed through the field_* functions.
+ */
+typedef uint8_t Field;
+
+#define FIELD_NUM_MINES 0x0F
+#define FIELD_MINE (1 << 4)
+#define FIELD_FLAGGED (1 << 5)
+#define FIELD_REVEALED (1 << 6)
+
+static inline uint8_t field_is_mine(Field field)
+{
+	return field & FIELD_MINE;
+}
+
+static inline uint8_t field_is_flagged(Field field)
+{
+	return field & FIELD_FLAGGED;
+}
+
+static inline uint8_t field_is_revealed(Field field)
+{
+	return field & FIELD_REVEALED;
+}
+
+/**
+ * Get the number of neighbouring mines.
+ * A mine counts itself as one of its neighbours.
+ */
+static inline uint8_t field_num_mines(Field field)
+{
+	return field & FIELD_NUM_MINES;
+}
+
+/**
+ * Set, clear or toggle the given FIELD_* state bits.
+ */
+static inline void field_set(Field *field, uint8_t bits)
+{
+	*field |= bits;
+}
+
+static inline void field_clear(Field *field, uint8_t bits)
+{
+	*field &= ~bits;
+}
+
+static inline void field_toggle(Field *field, uint8_t bits)
+{
+	*field ^= bits;
+}
+
+/**
+ * Add to the number of neighbouring mines.
+ * The count must stay within 0 and 15, as it would otherwise
+ * overflow into the state bits.
+ */
+static inline void field_add_mines(Field *field, int8_t increment)
+{
+	*field += increment;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#include <avr/pgmspace.h>
+
+#include <stdint.h>
+
+#include "format.h"
+
+// Both digits of every number from 0 to 99,
+// so no division is needed below one hundred.
+static const char DIGIT_PAIRS[] PROGMEM =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+uint8_t format_decimal(char *str, uint16_t value, uint8_t width)
+{
+	// Digits are found from the lowest ones, two at a time.
+	char digits[5];
+	uint8_t length = 0;
+	char *start = str;
+
+	while (value >= 100) {
+		uint8_t pair = value % 100;
+
+		value /= 100;
+		digits[length++] = pgm_read_byte(&DIGIT_PAIRS[pair * 2 + 1]);
+		digits[length++] = pgm_read_byte(&DIGIT_PAIRS[pair * 2]);
+	}
+
+	digits[length++] = pgm_read_byte(&DIGIT_PAIRS[value * 2 + 1]);
+
+	if (value >= 10) {
+		digits[length++] = pgm_read_byte(&DIGIT_PAIRS[value * 2]);
+	}
+
+	for (; width > length; width--) {
+		*str++ = '0';
+	}
+
+	while (length) {
+		*str++ = digits[--length];
+	}
+
+	*str = '\0';
+
+	return str - start;
+}
+
+uint8_t format_time(char *str, uint8_t min, uint8_t sec)
+{
+	uint8_t length = format_decimal(str, min, 2);
+
+	str[length++] = ':';
+
+	return length + format_decimal(str + length, sec, 2);
+}
@@ -0,0 +1,36 @@
+/**
+ * Number formatting utilities
+ * for the AVR Mines game.
+ *
+ * These replace sprintf in the render path.
+ */
+
+#ifndef MINES_FORMAT
+#define MINES_FORMAT
+
+#include <stdint.h>
+
+/**
+ * Format a number in decimal, padded with zeros as in "%0*d".
+ * The string is null-terminated.
+ *
+ * @str: the string will be returned in this array,
+ *	which must fit at least max(width, 5) + 1 characters
+ * @width: the minimum amount of digits
+ *
+ * @return: the amount of characters written, not counting the terminator
+ */
+uint8_t format_decimal(char *str, uint16_t value, uint8_t width);
+
+/**
+ * Format a time in MM:SS format.
+ * The string is null-terminated.
+ *
+ * @str: the string will be returned in this array,
+ *	which must fit at least 8 characters
+ *
+ * @return: the amount of characters written, not counting the terminator
+ */
+uint8_t format_time(char *str, uint8_t min, uint8_t sec);
+
+#endif
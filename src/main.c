@@ -9,116 +9,400 @@
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
 #include <util/delay.h>
 
-#include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "bitboard.h"
 #include "board.h"
+#ifdef BOARD_FIXED
+#include "board_fixed.h"
+#endif
 #include "chars.h"
+#include "clock.h"
+#include "events.h"
 #include "nokia5110.h"
+#include "profile.h"
+#include "random.h"
+#include "solver.h"
 #include "usart.h"
 #include "writing.h"
 
-// Specify the board's dimensions in lines and columns.
-#define BOARD_WIDTH 14
-#define BOARD_HEIGHT 5
-#define UP PIND &(1 << PD1)
-#define LEFT PIND &(1 << PD2)
-#define DOWN PIND &(1 << PD3)
-#define RIGHT PIND &(1 << PD4)
-#define FLAG PIND &(1 << PD6)
-#define CHECK PIND &(1 << PD7)
-
-const int8_t MINE_AMOUNT = 14;
-const int TIMER_CLK = F_CPU / 1024;
-// Update the timer once per second.
-const int TIMER_FREQ = 1;
-
-static State g_game_state = MENU;
-static Field g_board[BOARD_HEIGHT][BOARD_WIDTH];
+// The largest preset, for which RAM is budgeted at compile time.
+#define BOARD_MAX_WIDTH 30
+#define BOARD_MAX_HEIGHT 16
+// RAM taken by the state sized by the board, out of 2KB: the board,
+// its change log, the progress of the solver and the bitboards
+// kept on the stack at once, of which there are BOARD_STACK_BITBOARDS.
+#define BOARD_RAM_BUDGET 1024
+// Bitboards on the stack at most at once, as reveal_section,
+// generate_mines and solver_hint each keep one and never nest.
+#define BOARD_STACK_BITBOARDS 1
+// The status line is written below the fields shown.
+#define STATUS_Y (SCREEN_ROWS * 8)
+#define UP (1 << PD1)
+#define LEFT (1 << PD2)
+#define DOWN (1 << PD3)
+#define RIGHT (1 << PD4)
+#define FLAG (1 << PD6)
+#define CHECK (1 << PD7)
+#define BUTTONS (UP | LEFT | DOWN | RIGHT | FLAG | CHECK)
+#define DIRECTIONS (UP | LEFT | DOWN | RIGHT)
+// Marks movement repeated while a direction is held,
+// or a hint carrying on from the last frame.
+// PD0 is not a button, so this bit is free in events.
+#define REPEAT (1 << PD0)
+// Asks for a hint, when both vertical directions are pressed together.
+// PD5 is not a button either.
+#define HINT (1 << PD5)
+#define HINT_CHORD (UP | DOWN)
+// A vertical direction only moves this long after being pressed,
+// so pressing the other one meanwhile asks for a hint instead.
+#define CHORD_MS 40
+// Ignore changes of a button for 5ms after its last one.
+#define DEBOUNCE_MS 5
+// Held directions are checked 100 times per second.
+#define REPEAT_FREQ 100
+// Delay before the first repetition, in 10ms steps.
+#define REPEAT_DELAY 40
+// Delay between repetitions, which shrinks by REPEAT_ACCEL
+// after each one until REPEAT_MIN is reached.
+#define REPEAT_INTERVAL 15
+#define REPEAT_ACCEL 2
+#define REPEAT_MIN 4
+
+#if BOARD_MAX_WIDTH > BITBOARD_MAX_WIDTH
+#error "BOARD_MAX_WIDTH may not exceed BITBOARD_MAX_WIDTH"
+#endif
+
+/**
+ * Represent a difficulty preset, selectable from the menu.
+ * No preset may exceed BOARD_MAX_WIDTH or BOARD_MAX_HEIGHT.
+ */
+typedef struct preset {
+	char name[13];
+	uint8_t width;
+	uint8_t height;
+	uint16_t mines;
+} Preset;
+
+static const Preset PRESETS[] PROGMEM = {
+	{"Classic", 14, 5, 14},
+	{"Beginner", 9, 9, 10},
+	{"Intermediate", 16, 16, 40},
+	{"Expert", BOARD_MAX_WIDTH, BOARD_MAX_HEIGHT, 99}
+};
+
+#define PRESET_AMOUNT (sizeof(PRESETS) / sizeof(PRESETS[0]))
+
+static volatile State g_game_state = MENU;
+// Set by interruptions whenever the screen has to be redrawn.
+static volatile uint8_t g_redraw = 0;
+// Random seed, taken from the timer when gameplay is started.
+static uint16_t g_seed = 0;
+// Buttons pressed, as masks of the button pins.
+static EventQueue g_input;
+// Debounced state of the buttons.
+static volatile uint8_t g_buttons = 0;
+// Buttons which changed too soon after their last change,
+// to be sampled again once they settle.
+static volatile uint8_t g_bouncing = 0;
+// Steps left until a held direction is repeated.
+static volatile uint8_t g_repeat_countdown;
+static volatile uint8_t g_repeat_interval;
+// Vertical direction held back until CHORD_MS after its press.
+static volatile uint8_t g_chord_press = 0;
+static volatile uint8_t g_chord_at;
+// Preset selected in the menu and the size of its board.
+static uint8_t g_preset = 0;
+// Whether boards are generated to be solvable without guessing.
+static uint8_t g_no_guess = 0;
+static uint8_t g_width;
+static uint8_t g_height;
+static uint16_t g_mines;
+// Fields of the board, laid out as Field[g_height][g_width].
+static Field g_cells[BOARD_MAX_HEIGHT * BOARD_MAX_WIDTH];
+// Fields to redraw on the next frame.
+static BitRow g_changes[BOARD_MAX_HEIGHT];
 // This is the amount of empty fields left to be revealed
 // until victory is achieved.
-static int8_t g_fields_left;
-static int8_t g_flags_placed = 0;
+static uint16_t g_fields_left;
+static uint16_t g_flags_placed = 0;
 // Store the coordinates of the currently selected field.
 static uint8_t g_sel_x = 0;
 static uint8_t g_sel_y = 0;
+// Store the first column and row shown of boards larger than the screen.
+static uint8_t g_view_x = 0;
+static uint8_t g_view_y = 0;
+// Set when a hint ran out of work, to carry on next frame
+// from the progress it kept.
+static uint8_t g_hint_pending = 0;
+// Set when the generation of a board without guessing ran out of work,
+// to carry on next frame, along with the boards it tried.
+static uint8_t g_generate_pending = 0;
+static uint16_t g_boards_tried;
+// Set when no board without guessing was found,
+// so the board played may need guessing.
+static uint8_t g_may_guess;
+// Progress kept by hints and by generation, which never overlap,
+// as boards are only generated before the game is played.
+static BitRow g_solver_progress[SOLVER_GENERATE_BITBOARDS * BOARD_MAX_HEIGHT];
 // Track elapsed time.
-static int8_t g_min = 0;
-static int8_t g_sec = 0;
-
-void handle_buttons(Field *sel_field);
-void handle_movement();
+static uint8_t g_min = 0;
+static uint8_t g_sec = 0;
+
+_Static_assert(
+	SOLVER_HINT_BITBOARDS <= SOLVER_GENERATE_BITBOARDS,
+	"Hints do not fit in the progress kept for generation"
+);
+
+_Static_assert(
+	sizeof(g_cells) + sizeof(g_changes) + sizeof(g_solver_progress) +
+		BOARD_STACK_BITBOARDS * BOARD_MAX_HEIGHT * sizeof(BitRow) <=
+		BOARD_RAM_BUDGET,
+	"The largest preset exceeds BOARD_RAM_BUDGET"
+);
+
+void handle_buttons(uint8_t pressed, Field *sel_field);
+void handle_input();
+void handle_movement(uint8_t pressed);
+void show_hint(uint8_t resumed);
+uint8_t generate_board();
+void follow_selection();
+void load_preset();
 void setup();
+void wait_for_events();
 
 int main()
 {
 	setup();
-	int seed = 0;
 
 	while (1) {
+		// Screens are cleared once, after which frames only redraw
+		// the fields logged as changed, and only the cells which
+		// changed are rendered.
+		nokia_lcd_clear();
+		write_menu();
+
 		while (g_game_state == MENU) {
-			nokia_lcd_clear();
-			write_menu();
-			// Obtain a random seed from the time taken to start gameplay.
-			seed++;
-			nokia_lcd_render();
+			write_mode(2 * 8, g_no_guess);
+			write_difficulty(
+				3 * 8, PRESETS[g_preset].name,
+				pgm_read_byte(&PRESETS[g_preset].width),
+				pgm_read_byte(&PRESETS[g_preset].height),
+				pgm_read_word(&PRESETS[g_preset].mines)
+			);
+
+			nokia_lcd_render_begin();
+			wait_for_events();
 		}
 
+		load_preset();
+
+		Field (*board)[g_width] = (Field (*)[g_width]) g_cells;
+
 		g_sec = 0;
 		g_min = 0;
 		g_sel_x = 0;
 		g_sel_y = 0;
+		g_view_x = 0;
+		g_view_y = 0;
 		g_flags_placed = 0;
-		g_fields_left = BOARD_HEIGHT * BOARD_WIDTH - MINE_AMOUNT;
-		srand(seed);
-		reset_board(BOARD_WIDTH, BOARD_HEIGHT, g_board, MINE_AMOUNT);
+		g_boards_tried = 0;
+		g_may_guess = 0;
+		g_fields_left = (uint16_t) g_height * g_width - g_mines;
+		random_seed(g_seed);
+		reset_board(g_width, g_height, board, g_mines);
+
+		PROFILE_BEGIN(clear_start);
+		nokia_lcd_clear();
+		// Only the first frame draws the whole board.
+		memset(g_changes, 0xFF, sizeof(g_changes));
+		PROFILE_END(PROFILE_CLEAR, clear_start);
 
 		while (g_game_state == START || g_game_state == PLAYING) {
-			nokia_lcd_clear();
+			PROFILE_BEGIN(board_start);
 
 			write_board(
-				BOARD_WIDTH, BOARD_HEIGHT, g_board,
-				g_sel_x, g_sel_y, g_game_state
+				g_width, g_height, board, g_changes,
+				g_view_x, g_view_y, g_sel_x, g_sel_y, g_game_state
 			);
 
-			write_timer(0, BOARD_HEIGHT * 8, g_min, g_sec);
+			PROFILE_END(PROFILE_BOARD, board_start);
+			PROFILE_BEGIN(status_start);
 
-			write_flag_count(
-				BOARD_WIDTH * 5 - 22, BOARD_HEIGHT * 8,
-				g_flags_placed, MINE_AMOUNT
-			);
+			if (g_generate_pending) {
+				write_generating(0, STATUS_Y, g_boards_tried);
+			} else {
+				write_timer(0, STATUS_Y, g_min, g_sec);
+
+				// Right after the 6 characters of the timer,
+				// which are followed by a mark on boards which may
+				// need guessing though it was not asked for.
+				nokia_lcd_write_char(g_may_guess ? '?' : ' ', 1);
+				write_flag_count(7 * 6, STATUS_Y, g_flags_placed, g_mines);
+			}
+
+			PROFILE_END(PROFILE_STATUS, status_start);
+			PROFILE_BEGIN(render_start);
 
-			nokia_lcd_render();
+			// The next frame is drawn while this one is being sent.
+			nokia_lcd_render_begin();
+
+			PROFILE_END(PROFILE_RENDER, render_start);
+			PROFILE_FRAME();
+
+			wait_for_events();
 		}
 
 		nokia_lcd_clear();
-		reveal_board(BOARD_WIDTH, BOARD_HEIGHT, g_board);
+		reveal_board(g_width, g_height, board);
+		memset(g_changes, 0xFF, sizeof(g_changes));
 
 		write_board(
-			BOARD_WIDTH, BOARD_HEIGHT, g_board,
-			g_sel_x, g_sel_y, g_game_state
+			g_width, g_height, board, g_changes,
+			g_view_x, g_view_y, g_sel_x, g_sel_y, g_game_state
 		);
 
 		if (g_game_state == DEFEAT) {
-			write_defeat(0, BOARD_HEIGHT * 8);
+			write_defeat(0, STATUS_Y);
 		} else {
-			write_victory(0, BOARD_HEIGHT * 8);
+			write_victory(0, STATUS_Y);
 		}
 
+		nokia_lcd_render_begin();
+
 		while (g_game_state != MENU) {
-			nokia_lcd_render();
+			wait_for_events();
 		}
 	}
 }
 
+/**
+ * Sleep until an interruption requests the screen to be redrawn
+ * or a button is pressed, then handle the buttons pressed.
+ */
+void wait_for_events()
+{
+	cli();
+
+	while (
+		!g_redraw && event_queue_empty(&g_input) &&
+		!g_hint_pending && !g_generate_pending
+	) {
+		// Interruptions are only enabled after the instruction
+		// following sei, so none can be missed before sleeping.
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+		cli();
+	}
+
+	g_redraw = 0;
+	sei();
+
+	handle_input();
+}
+
+/**
+ * Take the next button pressed. Once none is left, a hint which ran
+ * out of work carries on as a repeated HINT, once per frame.
+ * Generation carries on likewise as a repeated CHECK,
+ * while the buttons pressed meanwhile are dropped.
+ *
+ * @resumed: set once the hint or generation carried on
+ *
+ * @return: 1 if there is anything to handle, 0 otherwise.
+ */
+static uint8_t next_press(uint8_t *pressed, uint8_t *resumed)
+{
+	if (g_generate_pending) {
+		// The board opens from the selected field, which must stay.
+		while (event_pop(&g_input, pressed)) {
+		}
+
+		if (*resumed) {
+			return 0;
+		}
+
+		g_generate_pending = 0;
+		*resumed = 1;
+		*pressed = CHECK | REPEAT;
+		return 1;
+	}
+
+	if (event_pop(&g_input, pressed)) {
+		return 1;
+	}
+
+	if (!g_hint_pending || *resumed) {
+		return 0;
+	}
+
+	g_hint_pending = 0;
+
+	// Hints are only carried on in the game they were asked in.
+	if (g_game_state != PLAYING) {
+		return 0;
+	}
+
+	*resumed = 1;
+	*pressed = HINT | REPEAT;
+	return 1;
+}
+
+/**
+ * Apply the buttons pressed, outside of interruptions,
+ * so the board never changes while it is being drawn.
+ * Events after a change of screen are left in the queue
+ * until the new screen is set up.
+ */
+void handle_input()
+{
+	State state = g_game_state;
+	Field (*board)[g_width] = (Field (*)[g_width]) g_cells;
+	uint8_t pressed;
+	uint8_t resumed = 0;
+
+	while (g_game_state == state && next_press(&pressed, &resumed)) {
+		PROFILE_BEGIN(start);
+
+		if (g_game_state == MENU) {
+			// Select a preset with the horizontal directions,
+			// and toggle guessing with the vertical ones.
+			if (pressed & LEFT) {
+				g_preset = move_wrapping(g_preset, -1, PRESET_AMOUNT);
+			} else if (pressed & RIGHT) {
+				g_preset = move_wrapping(g_preset, 1, PRESET_AMOUNT);
+			} else if (pressed & (UP | DOWN)) {
+				g_no_guess = !g_no_guess;
+			}
+		}
+
+		if (g_game_state == START || g_game_state == PLAYING) {
+			// Redraw the field left by the selection, as well as the
+			// selected one, which is the only one buttons change
+			// other than those revealed by reveal_section.
+			board_log_change(g_changes, g_sel_y, g_sel_x);
+			handle_movement(pressed);
+			board_log_change(g_changes, g_sel_y, g_sel_x);
+			follow_selection();
+		}
+
+		handle_buttons(pressed, &board[g_sel_y][g_sel_x]);
+		PROFILE_END(PROFILE_INPUT, start);
+	}
+}
+
 /**
  * Increment the timer.
  */
-ISR(TIMER1_COMPA_vect)
+void clock_second()
 {
 	if (g_game_state == PLAYING) {
 		g_sec++;
@@ -127,61 +411,256 @@ ISR(TIMER1_COMPA_vect)
 			g_sec = 0;
 			g_min++;
 		}
+
+		g_redraw = 1;
+	}
+}
+
+/**
+ * Queue a press, and schedule repetitions while a direction is held,
+ * unless it is part of a chord or held back for one.
+ * This must only be called from interruptions.
+ */
+static void queue_press(uint8_t pressed)
+{
+	uint8_t held = g_buttons & DIRECTIONS & ~g_chord_press;
+
+	if (pressed) {
+		event_push(&g_input, pressed);
+	}
+
+	if (pressed & held) {
+		g_repeat_countdown = REPEAT_DELAY;
+		g_repeat_interval = REPEAT_INTERVAL;
+		TCNT0 = 0;
+		TIMSK0 |= (1 << OCIE0A);
+	} else if (!held || pressed == HINT) {
+		TIMSK0 &= ~(1 << OCIE0A);
+	}
+}
+
+/**
+ * Queue the vertical direction held back for a chord, if any.
+ * This must only be called from interruptions.
+ */
+static void release_chord_press()
+{
+	uint8_t pressed = g_chord_press;
+
+	if (pressed) {
+		g_chord_press = 0;
+		queue_press(pressed);
+	}
+}
+
+/**
+ * Apply the changes of the buttons which settled, queueing presses.
+ * Each button is debounced on its own: a change is ignored for
+ * DEBOUNCE_MS after the last one applied to the same button,
+ * after which the button is sampled again from the clock,
+ * so changes are never lost while it bounces.
+ * This must only be called from interruptions.
+ */
+static void debounce_buttons()
+{
+	// Only the low byte of the time is kept, which is enough to
+	// tell changes DEBOUNCE_MS apart. Changes 256ms apart may be
+	// taken as bouncing, which only delays them until sampled again.
+	static uint8_t changed_at[8];
+	uint8_t now = clock_millis();
+	uint8_t changed = (PIND & BUTTONS) ^ g_buttons;
+	uint8_t settled = 0;
+
+	g_bouncing = 0;
+
+	for (uint8_t pin = 0; pin < 8; pin++) {
+		uint8_t bit = 1 << pin;
+
+		if (!(changed & bit)) {
+			continue;
+		}
+
+		if ((uint8_t) (now - changed_at[pin]) < DEBOUNCE_MS) {
+			g_bouncing |= bit;
+			continue;
+		}
+
+		changed_at[pin] = now;
+		settled |= bit;
+	}
+
+	if (!settled) {
+		return;
+	}
+
+	g_buttons ^= settled;
+
+	uint8_t pressed = settled & g_buttons;
+
+	// A chord replaces the press completing it, as well as the one
+	// held back, so the selection does not move before the hint.
+	if ((pressed & HINT_CHORD) && (g_buttons & HINT_CHORD) == HINT_CHORD) {
+		g_chord_press = 0;
+		queue_press(HINT);
+		return;
+	}
+
+	// Any other change ends the wait, so presses keep their order.
+	release_chord_press();
+
+	if (pressed & HINT_CHORD) {
+		g_chord_press = pressed & HINT_CHORD;
+		g_chord_at = now;
+		pressed &= ~HINT_CHORD;
+	}
+
+	queue_press(pressed);
+}
+
+/**
+ * Sample the buttons which were bouncing once their changes settle,
+ * and move in a vertical direction no chord followed.
+ */
+void clock_tick()
+{
+	if (g_bouncing) {
+		debounce_buttons();
+	}
+
+	if (
+		g_chord_press &&
+		(uint8_t) ((uint8_t) clock_millis() - g_chord_at) >= CHORD_MS
+	) {
+		release_chord_press();
 	}
 }
 
 /**
  * Handle button interruptions.
+ * Presses are only queued here, once their buttons are debounced.
  */
 ISR(PCINT2_vect)
 {
-	if (g_game_state == START || g_game_state == PLAYING) {
-		handle_movement();
+	PROFILE_BEGIN(start);
+	debounce_buttons();
+	PROFILE_END(PROFILE_ISR_BUTTONS, start);
+}
+
+/**
+ * Repeat held directions, faster the longer they are held.
+ */
+ISR(TIMER0_COMPA_vect)
+{
+	if (--g_repeat_countdown) {
+		return;
 	}
 
-	handle_buttons(&g_board[g_sel_y][g_sel_x]);
+	PROFILE_BEGIN(start);
+
+	// Only repeat once the previous movement was handled,
+	// so the cursor stops as soon as the direction is released.
+	if (event_queue_empty(&g_input)) {
+		event_push(&g_input, (g_buttons & DIRECTIONS & ~g_chord_press) | REPEAT);
+	}
+
+	if (g_repeat_interval >= REPEAT_MIN + REPEAT_ACCEL) {
+		g_repeat_interval -= REPEAT_ACCEL;
+	}
+
+	g_repeat_countdown = g_repeat_interval;
+	PROFILE_END(PROFILE_ISR_REPEAT, start);
 }
 
-void handle_buttons(Field *sel_field)
+/**
+ * Scroll the view of boards larger than the screen
+ * to the selected field, redrawing the whole window if it moves.
+ */
+void follow_selection()
 {
-	if (CHECK) {
+	uint8_t view_x = view_follow(g_view_x, g_sel_x, g_width, SCREEN_COLUMNS);
+	uint8_t view_y = view_follow(g_view_y, g_sel_y, g_height, SCREEN_ROWS);
+
+	if (view_x != g_view_x || view_y != g_view_y) {
+		g_view_x = view_x;
+		g_view_y = view_y;
+		memset(g_changes, 0xFF, sizeof(g_changes));
+	}
+}
+
+/**
+ * Load the size of the board from the preset selected.
+ */
+void load_preset()
+{
+	g_width = pgm_read_byte(&PRESETS[g_preset].width);
+	g_height = pgm_read_byte(&PRESETS[g_preset].height);
+	g_mines = pgm_read_word(&PRESETS[g_preset].mines);
+}
+
+void handle_buttons(uint8_t pressed, Field *sel_field)
+{
+	Field (*board)[g_width] = (Field (*)[g_width]) g_cells;
+
+	if (pressed & CHECK) {
 		if (g_game_state == MENU) {
+			// Obtain a random seed from the time taken to start gameplay.
+			g_seed = TCNT1 ^ clock_millis();
 			g_game_state = START;
 			return;
 		}
 
 		if (g_game_state == START) {
-			g_game_state = PLAYING;
-
-			// If the first field revealed is a mine,
-			// move it to the last field, which is otherwise always empty.
-			if (sel_field->mine) {
-				move_mine(
-					g_sel_y, g_sel_x, BOARD_HEIGHT - 1, BOARD_WIDTH - 1,
-					BOARD_WIDTH, BOARD_HEIGHT,
-					g_board
-				);
+			// Mines are moved once the first field is known, so it
+			// always opens a section, from which boards without
+			// guessing can also be solved.
+			if (g_no_guess) {
+				// The field is only revealed once the board is generated.
+				if (!generate_board()) {
+					return;
+				}
+			} else {
+				PROFILE_BEGIN(start);
+				clear_opening(g_sel_y, g_sel_x, g_width, g_height, board);
+				PROFILE_END(PROFILE_GENERATE, start);
 			}
+
+			g_game_state = PLAYING;
 		}
 
 		if (g_game_state == PLAYING) {
-			if (sel_field->mine) {
-				sel_field->revealed = 1;
+			if (field_is_mine(*sel_field)) {
+				field_set(sel_field, FIELD_REVEALED);
 				g_game_state = DEFEAT;
 			} else {
-				if (sel_field->revealed) {
+				if (field_is_revealed(*sel_field)) {
 					return;
 				}
 
-				uint8_t fields_revealed = 0;
-				uint8_t flags_removed = 0;
-
+				uint16_t fields_revealed = 0;
+				uint16_t flags_removed = 0;
+
+				PROFILE_BEGIN(start);
+
+#ifdef BOARD_FIXED
+				// Boards of the size the engine was specialised for
+				// are revealed without bounds checks.
+				if (g_width == BOARD_WIDTH && g_height == BOARD_HEIGHT) {
+					fixed_reveal_section(
+						&fields_revealed, &flags_removed, g_sel_y, g_sel_x,
+						(Field (*)[BOARD_WIDTH]) g_cells, g_changes
+					);
+				} else
+#endif
 				reveal_section(
 					&fields_revealed, &flags_removed,
-					g_sel_y, g_sel_x, BOARD_WIDTH, BOARD_HEIGHT,
-					g_board
+					g_sel_y, g_sel_x, g_width, g_height,
+					board, g_changes
 				);
 
+				PROFILE_END(PROFILE_REVEAL, start);
+
+				// A hint carrying on would not check the fields revealed.
+				g_hint_pending = 0;
 				g_fields_left -= fields_revealed;
 				g_flags_placed -= flags_removed;
 
@@ -190,31 +669,136 @@ void handle_buttons(Field *sel_field)
 				}
 			}
 		}
-	} else if (FLAG) {
+	} else if (pressed & FLAG) {
 		if (g_game_state == DEFEAT || g_game_state == VICTORY) {
 			g_game_state = MENU;
-		} else if (!sel_field->revealed) {
-			sel_field->flagged ^= 1;
+		} else if (!field_is_revealed(*sel_field)) {
+			field_toggle(sel_field, FIELD_FLAGGED);
 
-			g_flags_placed = sel_field->flagged ?
+			g_flags_placed = field_is_flagged(*sel_field) ?
 				g_flags_placed + 1 : g_flags_placed - 1;
 		}
 	}
 }
 
-void handle_movement()
+void handle_movement(uint8_t pressed)
 {
-	if (UP) {
-		g_sel_y = move_wrapping(g_sel_y, -1, BOARD_HEIGHT);
-	} else if (DOWN) {
-		g_sel_y = move_wrapping(g_sel_y, 1, BOARD_HEIGHT);
-	} else if (LEFT) {
-		g_sel_x = move_wrapping(g_sel_x, -1, BOARD_WIDTH);
-	} else if (RIGHT) {
-		g_sel_x = move_wrapping(g_sel_x, 1, BOARD_WIDTH);
+	Field (*board)[g_width] = (Field (*)[g_width]) g_cells;
+	int8_t dx = 0;
+	int8_t dy = 0;
+
+	if (pressed & HINT) {
+		show_hint(pressed & REPEAT);
+		return;
+	}
+
+	// Repetitions skip the fields which need no action.
+	if (pressed & REPEAT) {
+		if (pressed & UP) {
+			dy = -1;
+		} else if (pressed & DOWN) {
+			dy = 1;
+		} else if (pressed & LEFT) {
+			dx = -1;
+		} else if (pressed & RIGHT) {
+			dx = 1;
+		}
+
+		if (dx) {
+			g_sel_x = move_to_hidden(
+				g_sel_x, g_sel_y, dx, dy, g_width, g_height, board
+			);
+		} else if (dy) {
+			g_sel_y = move_to_hidden(
+				g_sel_x, g_sel_y, dx, dy, g_width, g_height, board
+			);
+		}
+
+		return;
+	}
+
+	if (pressed & UP) {
+		g_sel_y = move_wrapping(g_sel_y, -1, g_height);
+	} else if (pressed & DOWN) {
+		g_sel_y = move_wrapping(g_sel_y, 1, g_height);
+	} else if (pressed & LEFT) {
+		g_sel_x = move_wrapping(g_sel_x, -1, g_width);
+	} else if (pressed & RIGHT) {
+		g_sel_x = move_wrapping(g_sel_x, 1, g_width);
 	}
 }
 
+/**
+ * Select a field which the revealed fields prove to be safe,
+ * or flag one which they prove to be a mine.
+ * Nothing happens if the board cannot be solved without guessing.
+ * Hints which run out of work carry on over the next frames.
+ *
+ * @resumed: 1 to carry on with the last hint, 0 to start a new one
+ */
+void show_hint(uint8_t resumed)
+{
+	Field (*board)[g_width] = (Field (*)[g_width]) g_cells;
+	uint8_t row;
+	uint8_t col;
+
+	if (g_game_state != PLAYING) {
+		return;
+	}
+
+	PROFILE_BEGIN(start);
+	Deduction deduction = solver_hint(
+		g_width, g_height, board, &row, &col, g_solver_progress, resumed
+	);
+	PROFILE_END(PROFILE_HINT, start);
+
+	g_hint_pending = deduction == DEDUCED_UNFINISHED;
+
+	if (deduction == DEDUCED_NOTHING || deduction == DEDUCED_UNFINISHED) {
+		return;
+	}
+
+	g_sel_x = col;
+	g_sel_y = row;
+
+	// Only unflagged mines are hinted.
+	if (deduction == DEDUCED_MINE) {
+		field_set(&board[row][col], FIELD_FLAGGED);
+		g_flags_placed++;
+	}
+}
+
+/**
+ * Generate a board without guessing from the selected field.
+ * Generation which runs out of work carries on over the next frames.
+ * If no board is found, the last one tried is kept, which opens
+ * a section like boards which may need guessing.
+ *
+ * @return: 1 once the board is generated, 0 otherwise.
+ */
+uint8_t generate_board()
+{
+	Field (*board)[g_width] = (Field (*)[g_width]) g_cells;
+
+	PROFILE_BEGIN(start);
+	Generation generation = solver_generate(
+		g_width, g_height, board, g_mines, g_sel_y, g_sel_x,
+		g_solver_progress, &g_boards_tried
+	);
+	PROFILE_END(PROFILE_GENERATE, start);
+
+	g_generate_pending = generation == GENERATED_UNFINISHED;
+
+	if (g_generate_pending) {
+		return 0;
+	}
+
+	PROFILE_COUNT(PROFILE_BOARDS_TRIED, g_boards_tried);
+	g_may_guess = generation == GENERATED_UNSOLVABLE;
+
+	return 1;
+}
+
 /**
  * Sets up the timer, inputs, interruptions and custom glyphs.
  */
@@ -222,14 +806,14 @@ void setup()
 {
 	cli();
 
-	// Set up the timer.
-	TCCR1A = 0;
-	TCCR1B = 0;
-	TCNT1 = 0;
-	OCR1A = (TIMER_CLK / TIMER_FREQ) - 1;
-	TCCR1B |= (1 << WGM12);
-	TCCR1B |= (1 << CS12) | (1 << CS10);
-	TIMSK1 |= (1 << OCIE1A);
+	// Set up the clock, which also keeps the game timer.
+	clock_init();
+
+	// Set up the timer for repeating held directions.
+	// Its interruption is only enabled while they are held.
+	TCCR0A = (1 << WGM01);
+	TCCR0B = (1 << CS02) | (1 << CS00);
+	OCR0A = (F_CPU / 1024 / REPEAT_FREQ) - 1;
 
 	// Set ports as input.
 	// These will be mapped to the buttons.
@@ -238,18 +822,24 @@ void setup()
 	// Toggle interruption vector for PD7, ..., PD0.
 	PCICR |= (1 << PCIE2);
 	// Toggle interruptions for every button.
-	PCMSK2 |= (1 << PD1) | (1 << PD2) | (1 << PD3) | (1 << PD4) | (1 << PD6) | (1 << PD7);
+	PCMSK2 |= BUTTONS;
+
+	// Sleep until the next interruption when there is nothing to draw.
+	set_sleep_mode(SLEEP_MODE_IDLE);
 
 	sei();
 
 	nokia_lcd_init();
-	// Cast the glyphs to uint8_t* to suppress warnings.
-	nokia_lcd_custom(1, (uint8_t*) CLOCK_GLYPH);
-	nokia_lcd_custom(2, (uint8_t*) UNREVEALED_GLYPH);
-	nokia_lcd_custom(3, (uint8_t*) SELECTED_GLYPH);
-	nokia_lcd_custom(4, (uint8_t*) FLAG_GLYPH);
-	nokia_lcd_custom(5, (uint8_t*) MINE_GLYPH);
+	// The glyphs are read straight from flash.
+	nokia_lcd_custom_P(1, CLOCK_GLYPH);
+	nokia_lcd_custom_P(2, UNREVEALED_GLYPH);
+	nokia_lcd_custom_P(3, SELECTED_GLYPH);
+	nokia_lcd_custom_P(4, FLAG_GLYPH);
+	nokia_lcd_custom_P(5, MINE_GLYPH);
 
 	// Initialize USART for debugging purposes.
 	USART_Init();
+
+	// The board always has the size of a preset.
+	load_preset();
 }
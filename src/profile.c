@@ -0,0 +1,145 @@
+#ifdef PROFILE
+
+#include <util/atomic.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "nokia5110.h"
+#include "profile.h"
+#include "usart.h"
+
+// Bytes of the header after the sync bytes, and of every stage,
+// as laid out in profile_frame.
+#define HEADER_SIZE 4
+#define STAGE_SIZE (2 + 3 * 4 + 2 * PROFILE_BUCKETS)
+// Taken by g_sending when no report is being sent.
+#define IDLE (PROFILE_STAGES + 1)
+
+typedef struct stage_stats {
+	uint16_t count;
+	uint32_t min;
+	uint32_t max;
+	uint32_t total;
+	uint16_t buckets[PROFILE_BUCKETS];
+} StageStats;
+
+static StageStats g_stats[PROFILE_STAGES];
+static uint16_t g_frames = 0;
+// Stage of the report to send next, PROFILE_STAGES for its checksum.
+static uint8_t g_sending = IDLE;
+static uint8_t g_checksum;
+static uint32_t g_lcd_start;
+
+/**
+ * Send a little-endian number as part of a report.
+ *
+ * @checksum: the bytes sent are added to this pointer
+ */
+static void send_le(uint8_t *checksum, uint32_t value, uint8_t size)
+{
+	for (uint8_t i = 0; i < size; i++) {
+		USART_SendByte(value);
+		*checksum += value;
+		value >>= 8;
+	}
+}
+
+void profile_record(ProfileStage stage, uint32_t cycles)
+{
+	uint8_t bucket = 0;
+
+	for (uint32_t limit = 1UL << PROFILE_BUCKET_SHIFT;
+		cycles >= limit && bucket < PROFILE_BUCKETS - 1; limit <<= 1
+	) {
+		bucket++;
+	}
+
+	// Interruptions record their stages too.
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		StageStats *stats = &g_stats[stage];
+
+		if (!stats->count || cycles < stats->min) {
+			stats->min = cycles;
+		}
+
+		if (cycles > stats->max) {
+			stats->max = cycles;
+		}
+
+		// Stop counting rather than overflowing.
+		if (stats->count < UINT16_MAX) {
+			stats->count++;
+			stats->total += cycles;
+			stats->buckets[bucket]++;
+		}
+	}
+}
+
+/**
+ * Send the statistics of a stage and reset them.
+ */
+static void send_stage(uint8_t stage)
+{
+	StageStats stats;
+
+	// Interruptions must stay enabled while sending.
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		stats = g_stats[stage];
+		memset(&g_stats[stage], 0, sizeof(StageStats));
+	}
+
+	send_le(&g_checksum, stats.count, 2);
+	send_le(&g_checksum, stats.min, 4);
+	send_le(&g_checksum, stats.count ? stats.total / stats.count : 0, 4);
+	send_le(&g_checksum, stats.max, 4);
+
+	for (uint8_t bucket = 0; bucket < PROFILE_BUCKETS; bucket++) {
+		send_le(&g_checksum, stats.buckets[bucket], 2);
+	}
+}
+
+void profile_frame()
+{
+	g_frames++;
+
+	// Sync, version, stage count and frames,
+	// then count, min, average, max and buckets of every stage
+	// and a checksum of everything after the sync bytes.
+	if (g_sending == IDLE && g_frames >= PROFILE_REPORT_FRAMES
+		&& USART_tx_free() >= 2 + HEADER_SIZE
+	) {
+		g_checksum = 0;
+		USART_SendByte(PROFILE_SYNC_0);
+		USART_SendByte(PROFILE_SYNC_1);
+		send_le(&g_checksum, PROFILE_VERSION, 1);
+		send_le(&g_checksum, PROFILE_STAGES, 1);
+		send_le(&g_checksum, g_frames, 2);
+		g_frames = 0;
+		g_sending = 0;
+	}
+
+	// A report does not fit the USART buffer, so its stages are only
+	// queued once there is room for them, over the next frames,
+	// rather than waiting for the USART.
+	while (g_sending < PROFILE_STAGES && USART_tx_free() >= STAGE_SIZE) {
+		send_stage(g_sending++);
+	}
+
+	if (g_sending == PROFILE_STAGES && USART_tx_free()) {
+		USART_SendByte(g_checksum);
+		g_sending = IDLE;
+	}
+}
+
+void nokia_lcd_isr_begin(void)
+{
+	g_lcd_start = clock_cycles();
+}
+
+void nokia_lcd_isr_end(void)
+{
+	profile_record(PROFILE_ISR_LCD, clock_cycles() - g_lcd_start);
+}
+
+#endif
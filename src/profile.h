@@ -0,0 +1,92 @@
+/**
+ * Frame profiler for the AVR Mines game.
+ *
+ * Build with PROFILE defined to time each stage of a frame,
+ * as well as interruptions, with clock_cycles. Every
+ * PROFILE_REPORT_FRAMES frames, the statistics of every stage are
+ * sent over USART as a binary report, which can be decoded with
+ * bench/profile_decode.py, and then reset.
+ * Reports are queued over the next frames as the USART buffer makes
+ * room for them, so each stage is reset as it is sent, and may count
+ * a few frames more than the report says.
+ *
+ * The display's interruptions are timed through its ISR hooks,
+ * which need LCD_ISR_HOOKS to be defined as well.
+ *
+ * Without PROFILE, the macros below expand to nothing.
+ */
+
+#ifndef MINES_PROFILE
+#define MINES_PROFILE
+
+#include <stdint.h>
+
+#ifndef PROFILE_REPORT_FRAMES
+#define PROFILE_REPORT_FRAMES 64
+#endif
+// Durations are bucketed by powers of two, from below 2^9 cycles
+// up to 2^15 cycles and over.
+#define PROFILE_BUCKETS 8
+#define PROFILE_BUCKET_SHIFT 9
+
+// Start of a report, followed by its version.
+#define PROFILE_SYNC_0 0xA5
+#define PROFILE_SYNC_1 0x5A
+#define PROFILE_VERSION 1
+
+/**
+ * Represent a profiled stage.
+ * bench/profile_decode.py must be updated alongside this.
+ */
+typedef enum profile_stage {
+	PROFILE_CLEAR,
+	PROFILE_BOARD,
+	PROFILE_STATUS,
+	PROFILE_RENDER,
+	PROFILE_INPUT,
+	PROFILE_REVEAL,
+	PROFILE_HINT,
+	PROFILE_GENERATE,
+	// Boards tried by solver_generate, counted rather than timed.
+	PROFILE_BOARDS_TRIED,
+	PROFILE_ISR_BUTTONS,
+	PROFILE_ISR_REPEAT,
+	PROFILE_ISR_CLOCK,
+	PROFILE_ISR_LCD,
+	PROFILE_STAGES
+} ProfileStage;
+
+#ifdef PROFILE
+
+#include "clock.h"
+
+#define PROFILE_BEGIN(start) uint32_t start = clock_cycles()
+#define PROFILE_END(stage, start) \
+	profile_record(stage, clock_cycles() - (start))
+#define PROFILE_COUNT(stage, amount) profile_record(stage, amount)
+#define PROFILE_FRAME() profile_frame()
+
+/**
+ * Add the duration of a stage to its statistics.
+ * Stages counted with PROFILE_COUNT add an amount instead.
+ *
+ * @cycles: the duration of the stage, in CPU cycles
+ */
+void profile_record(ProfileStage stage, uint32_t cycles);
+
+/**
+ * Count a frame, starting a report every PROFILE_REPORT_FRAMES frames,
+ * and queue as much of the report being sent as the USART buffer fits.
+ */
+void profile_frame();
+
+#else
+
+#define PROFILE_BEGIN(start)
+#define PROFILE_END(stage, start)
+#define PROFILE_COUNT(stage, amount)
+#define PROFILE_FRAME()
+
+#endif
+
+#endif
@@ -0,0 +1,25 @@
+#include <stdint.h>
+
+#include "random.h"
+
+// Xorshift never leaves zero, so it is never used as a state.
+static uint32_t g_state = 1;
+
+void random_seed(uint32_t seed)
+{
+	g_state = seed ? seed : 1;
+}
+
+uint32_t random_next()
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 17;
+	g_state ^= g_state << 5;
+
+	return g_state;
+}
+
+uint16_t random_below(uint16_t limit)
+{
+	return ((random_next() >> 16) * limit) >> 16;
+}
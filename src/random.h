@@ -0,0 +1,31 @@
+/**
+ * Pseudo-random number generator
+ * for the AVR Mines game.
+ *
+ * Unlike rand, the sequence only depends on the seed and is the same
+ * on every platform, so boards may be reproduced on the host.
+ */
+
+#ifndef MINES_RANDOM
+#define MINES_RANDOM
+
+#include <stdint.h>
+
+/**
+ * Restart the sequence from the given seed.
+ */
+void random_seed(uint32_t seed);
+
+/**
+ * Get the next number of the xorshift32 sequence.
+ */
+uint32_t random_next();
+
+/**
+ * Get a number from 0 up to, but not including, the limit.
+ * The upper bits of the sequence are scaled with a multiplication,
+ * so no division is needed.
+ */
+uint16_t random_below(uint16_t limit);
+
+#endif
@@ -0,0 +1,834 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "board.h"
+#include "random.h"
+#include "solver.h"
+
+// Pairs of fields are up to two fields apart, so the neighbours of
+// the second one are up to three fields away from the first one.
+#define REACH 3
+#define WINDOW (2 * REACH + 1)
+
+// Returned when fields are deduced, along with MARKED_NEW if any
+// of them is not a mine the player has already flagged.
+#define MARKED 1
+#define MARKED_NEW 2
+// Returned when a hint runs out of work with fields left to check.
+#define UNFINISHED 4
+
+/**
+ * State of the solver, shared by the functions below.
+ *
+ * Revealed fields are only checked again once a field close enough
+ * to change their rules is deduced or revealed, so they are kept
+ * in two bitboards of pending fields, like the frontier of
+ * reveal_section: one to check alone and one to check in pairs.
+ */
+typedef struct solver {
+	uint8_t width;
+	uint8_t height;
+	// Fields of the board, laid out as Field[height][width].
+	Field *board;
+	BitRow *open;
+	BitRow *mines;
+	BitRow *safe;
+	BitRow *pending;
+	BitRow *pending_pairs;
+	// Fields without neighbouring mines, given to reveal safe fields
+	// as they are deduced, or NULL to leave them unrevealed.
+	const BitRow *empty;
+	// Work left before stopping, as counted for SOLVER_HINT_WORK,
+	// or NULL to check fields until none is left.
+	uint16_t *work;
+} Solver;
+
+/**
+ * Fields around a revealed field, copied from the bitboards.
+ *
+ * Bit n of a row of the window maps to column col + n - REACH,
+ * and row n of the window to row row + n - REACH.
+ */
+typedef struct window {
+	uint8_t row;
+	uint8_t col;
+	uint8_t unknown[WINDOW];
+	uint8_t mines[WINDOW];
+	uint8_t open[WINDOW];
+} Window;
+
+static uint8_t count_bits(uint8_t bits)
+{
+	uint8_t count = 0;
+
+	for (; bits; bits &= bits - 1) {
+		count++;
+	}
+
+	return count;
+}
+
+static uint8_t count_cells(const uint8_t cells[WINDOW])
+{
+	uint8_t count = 0;
+
+	for (uint8_t i = 0; i < WINDOW; i++) {
+		count += count_bits(cells[i]);
+	}
+
+	return count;
+}
+
+/**
+ * Get the bits of a row from the given column on, which may be up to
+ * REACH columns left of the board, where there are none.
+ * Whole bytes are skipped first, since the AVR can only shift
+ * one bit at a time.
+ */
+static uint8_t bits_from(BitRow row, int8_t col)
+{
+	if (col < 0) {
+		return row << -col;
+	}
+
+	if (col >= 16) {
+		row >>= 16;
+		col -= 16;
+	}
+
+	if (col >= 8) {
+		row >>= 8;
+		col -= 8;
+	}
+
+	return row >> col;
+}
+
+/**
+ * Get the fields of a row which are neither revealed nor deduced.
+ * Rows outside the board have none.
+ */
+static BitRow unknown_row(const Solver *solver, int16_t row)
+{
+	if (row < 0 || row >= solver->height) {
+		return 0;
+	}
+
+	return ~(solver->open[row] | solver->mines[row] | solver->safe[row]) &
+		bitrow_mask(solver->width);
+}
+
+static Field solver_field(const Solver *solver, uint8_t row, uint8_t col)
+{
+	return solver->board[(uint16_t) row * solver->width + col];
+}
+
+/**
+ * Copy the fields around a revealed field into a window.
+ *
+ * @pairs: 1 to copy the whole window,
+ *	0 to copy the unknown fields and mines next to the field only
+ */
+static void window_load(
+	const Solver *solver, Window *window,
+	uint8_t row, uint8_t col, uint8_t pairs
+) {
+	uint8_t first = pairs ? 0 : REACH - 1;
+	uint8_t last = pairs ? WINDOW - 1 : REACH + 1;
+	int8_t from = (int8_t) col - REACH;
+
+	window->row = row;
+	window->col = col;
+
+	for (uint8_t i = first; i <= last; i++) {
+		int16_t src = (int16_t) row + i - REACH;
+
+		if (src < 0 || src >= solver->height) {
+			window->unknown[i] = 0;
+			window->mines[i] = 0;
+			window->open[i] = 0;
+			continue;
+		}
+
+		window->unknown[i] = bits_from(unknown_row(solver, src), from);
+		window->mines[i] = bits_from(solver->mines[src], from);
+
+		if (pairs) {
+			window->open[i] = bits_from(solver->open[src], from);
+		}
+	}
+}
+
+/**
+ * Get the unknown neighbours of a revealed field in the window
+ * and the amount of mines left among them.
+ *
+ * @i: the row of the field in the window
+ * @j: the column of the field in the window, from 1 to WINDOW - 2
+ * @cells: the unknown neighbours will be returned in this array,
+ *	with one row of the window per entry
+ *
+ * @return: the amount of mines left among the unknown neighbours
+ */
+static int8_t window_constraint(
+	const Solver *solver, const Window *window,
+	uint8_t i, uint8_t j, uint8_t cells[WINDOW]
+) {
+	uint8_t columns = 7 << (j - 1);
+	int8_t left = field_num_mines(solver_field(
+		solver, window->row + i - REACH, window->col + j - REACH
+	));
+
+	memset(cells, 0, WINDOW);
+
+	for (uint8_t k = i - 1; k <= i + 1; k++) {
+		cells[k] = window->unknown[k] & columns;
+		left -= count_bits(window->mines[k] & columns);
+	}
+
+	return left;
+}
+
+/**
+ * Queue the revealed fields whose rules may change once the given
+ * fields of a row are deduced or revealed: those next to them
+ * to be checked alone, and those up to REACH fields away in pairs.
+ */
+static void solver_touch(Solver *solver, uint8_t row, BitRow bits)
+{
+	BitRow near = bits | bits << 1 | bits >> 1;
+	BitRow far = near | near << 2 | near >> 2;
+
+	for (int16_t src = (int16_t) row - REACH; src <= row + REACH; src++) {
+		if (src < 0 || src >= solver->height) {
+			continue;
+		}
+
+		solver->pending_pairs[src] |= far & solver->open[src];
+
+		if (src + 1 >= row && src <= row + 1) {
+			solver->pending[src] |= near & solver->open[src];
+		}
+	}
+}
+
+/**
+ * Reveal safe fields of a row, cascading through fields without
+ * neighbouring mines like reveal_section, but without changing the board.
+ */
+static void solver_open(Solver *solver, uint8_t row, BitRow bits)
+{
+	BitRow inside = bitrow_mask(solver->width);
+	// Only rows next to those grown on the last pass may grow,
+	// so the cascade is not bounded by the size of the board.
+	int16_t first = (int16_t) row - 1;
+	int16_t last = (int16_t) row + 1;
+
+	solver->open[row] |= bits;
+	solver_touch(solver, row, bits);
+
+	while (1) {
+		int16_t grown_first = solver->height;
+		int16_t grown_last = -1;
+
+		if (first < 0) {
+			first = 0;
+		}
+
+		if (last >= solver->height) {
+			last = solver->height - 1;
+		}
+
+		for (int16_t i = first; i <= last; i++) {
+			BitRow around = 0;
+
+			for (int16_t src = i - 1; src <= i + 1; src++) {
+				if (src < 0 || src >= solver->height) {
+					continue;
+				}
+
+				BitRow cascade = solver->open[src] & solver->empty[src];
+
+				around |= cascade | cascade << 1 | cascade >> 1;
+			}
+
+			around &= inside & ~solver->open[i];
+
+			if (around) {
+				solver->open[i] |= around;
+				solver_touch(solver, i, around);
+
+				if (i < grown_first) {
+					grown_first = i;
+				}
+
+				grown_last = i;
+			}
+		}
+
+		if (grown_last < 0) {
+			return;
+		}
+
+		first = grown_first - 1;
+		last = grown_last + 1;
+	}
+}
+
+/**
+ * Record fields of the window as deduced.
+ *
+ * @cells: the fields deduced, with one row of the window per entry
+ * @mine: 1 if the fields are mines, 0 if they are safe
+ *
+ * @return: 0 if there are no fields, MARKED otherwise,
+ *	along with MARKED_NEW if any field is not a flagged mine.
+ */
+static uint8_t window_mark(
+	Solver *solver, const Window *window,
+	const uint8_t cells[WINDOW], uint8_t mine
+) {
+	uint8_t marked = 0;
+
+	for (uint8_t i = 0; i < WINDOW; i++) {
+		if (!cells[i]) {
+			continue;
+		}
+
+		uint8_t row = window->row + i - REACH;
+		BitRow bits = window->col >= REACH ?
+			(BitRow) cells[i] << (window->col - REACH) :
+			(BitRow) cells[i] >> (REACH - window->col);
+
+		marked |= MARKED;
+
+		if (!mine) {
+			solver->safe[row] |= bits;
+			marked |= MARKED_NEW;
+
+			if (solver->empty) {
+				solver_open(solver, row, bits);
+			} else {
+				solver_touch(solver, row, bits);
+			}
+
+			continue;
+		}
+
+		solver->mines[row] |= bits;
+		solver_touch(solver, row, bits);
+
+		for (uint8_t col = 0; bits && !(marked & MARKED_NEW); col++) {
+			if ((bits & 1) && !field_is_flagged(solver_field(solver, row, col))) {
+				marked |= MARKED_NEW;
+			}
+
+			bits >>= 1;
+		}
+	}
+
+	return marked;
+}
+
+/**
+ * Apply the single field rules to a revealed field.
+ */
+static uint8_t solver_check(Solver *solver, uint8_t row, uint8_t col)
+{
+	Window window;
+	uint8_t cells[WINDOW];
+
+	window_load(solver, &window, row, col, 0);
+
+	int8_t left = window_constraint(solver, &window, REACH, REACH, cells);
+	uint8_t amount = count_cells(cells);
+
+	if (amount && left == 0) {
+		return window_mark(solver, &window, cells, 0);
+	}
+
+	if (amount && left == amount) {
+		return window_mark(solver, &window, cells, 1);
+	}
+
+	return 0;
+}
+
+/**
+ * Compare a revealed field with every revealed field up to two fields
+ * away, until anything is deduced.
+ */
+static uint8_t solver_check_pairs(Solver *solver, uint8_t row, uint8_t col)
+{
+	Window window;
+	uint8_t cells[WINDOW];
+
+	window_load(solver, &window, row, col, 1);
+
+	int8_t left = window_constraint(solver, &window, REACH, REACH, cells);
+
+	if (!count_cells(cells)) {
+		return 0;
+	}
+
+	for (uint8_t i = 1; i <= WINDOW - 2; i++) {
+		for (uint8_t j = 1; j <= WINDOW - 2; j++) {
+			if ((i == REACH && j == REACH) || !((window.open[i] >> j) & 1)) {
+				continue;
+			}
+
+			uint8_t other[WINDOW];
+			uint8_t only[WINDOW];
+			uint8_t only_other[WINDOW];
+			int8_t other_left = window_constraint(
+				solver, &window, i, j, other
+			);
+
+			for (uint8_t k = 0; k < WINDOW; k++) {
+				only[k] = cells[k] & ~other[k];
+				only_other[k] = other[k] & ~cells[k];
+			}
+
+			uint8_t amount = count_cells(only);
+
+			if (!amount && !count_cells(only_other)) {
+				continue;
+			}
+
+			// The fields next to this field only hold every mine by
+			// which it exceeds the other, so all of them are mines
+			// if there are as many, and the other has no mines of its own.
+			// The other way around is found when checking the other field.
+			if (left - other_left == amount) {
+				return window_mark(solver, &window, only, 1) |
+					window_mark(solver, &window, only_other, 0);
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Take the first field out of a bitboard.
+ *
+ * @return: 0 if the bitboard is empty, 1 otherwise.
+ */
+static uint8_t take_field(
+	uint8_t board_height, BitRow rows[], uint8_t *row, uint8_t *col
+) {
+	for (*row = 0; *row < board_height; (*row)++) {
+		BitRow bits = rows[*row];
+
+		if (!bits) {
+			continue;
+		}
+
+		for (*col = 0; !(bits & 1); (*col)++) {
+			bits >>= 1;
+		}
+
+		rows[*row] &= ~((BitRow) 1 << *col);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Queue every revealed field next to unknown ones to be checked,
+ * both alone and in pairs.
+ */
+static void queue_frontier(Solver *solver)
+{
+	for (uint8_t i = 0; i < solver->height; i++) {
+		BitRow around = 0;
+
+		for (int16_t src = (int16_t) i - 1; src <= i + 1; src++) {
+			BitRow unknown = unknown_row(solver, src);
+
+			around |= unknown | unknown << 1 | unknown >> 1;
+		}
+
+		solver->pending[i] = solver->open[i] & around;
+		solver->pending_pairs[i] = solver->pending[i];
+	}
+}
+
+/**
+ * Check pending fields until none is left. Pairs are only compared
+ * once single fields give nothing, as they cost more.
+ *
+ * @stop: 1 to stop at the first field which is not a flagged mine
+ *
+ * @return: MARKED if anything was deduced, along with MARKED_NEW
+ *	if any field deduced is not a flagged mine, or UNFINISHED if
+ *	the solver ran out of work with fields left to check.
+ */
+static uint8_t solve(Solver *solver, uint8_t stop)
+{
+	uint8_t marked = 0;
+	uint8_t row;
+	uint8_t col;
+
+	while (1) {
+		BitRow *rows = solver->pending;
+		uint8_t work = 1;
+		uint8_t found;
+
+		if (!take_field(solver->height, rows, &row, &col)) {
+			rows = solver->pending_pairs;
+			work = SOLVER_PAIR_WORK;
+
+			if (!take_field(solver->height, rows, &row, &col)) {
+				break;
+			}
+		}
+
+		if (solver->work) {
+			// The field is left for the next call to check.
+			if (*solver->work < work) {
+				rows[row] |= (BitRow) 1 << col;
+				return marked | UNFINISHED;
+			}
+
+			*solver->work -= work;
+		}
+
+		if (rows == solver->pending) {
+			found = solver_check(solver, row, col);
+		} else {
+			found = solver_check_pairs(solver, row, col);
+		}
+
+		marked |= found;
+
+		if (stop && (found & MARKED_NEW)) {
+			break;
+		}
+	}
+
+	return marked;
+}
+
+uint8_t solver_deduce(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width],
+	const BitRow open[board_height],
+	BitRow mines[board_height], BitRow safe[board_height]
+) {
+	BitRow pending[board_height];
+	BitRow pending_pairs[board_height];
+	Solver solver = {
+		board_width, board_height, &board[0][0],
+		// Fields are only revealed when empty is given, which it is not.
+		(BitRow *) open, mines, safe, pending, pending_pairs, NULL, NULL
+	};
+
+	queue_frontier(&solver);
+	return solve(&solver, 0) != 0;
+}
+
+Deduction solver_hint(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width],
+	uint8_t *row, uint8_t *col,
+	BitRow progress[SOLVER_HINT_BITBOARDS * board_height], uint8_t resumed
+) {
+	BitRow safe[board_height];
+	BitRow *open = progress;
+	BitRow *mines = progress + board_height;
+	uint16_t work = SOLVER_HINT_WORK;
+	Solver solver = {
+		board_width, board_height, &board[0][0],
+		open, mines, safe, progress + 2 * board_height,
+		progress + 3 * board_height, NULL, &work
+	};
+
+	// Safe fields are never kept, as the hint stops at the first one.
+	memset(safe, 0, sizeof(safe));
+
+	// Only a new hint reads the whole board. One carrying on keeps
+	// the fields revealed when it started, as no other may be revealed.
+	if (!resumed) {
+		bitboard_from_board(
+			board_width, board_height, board, FIELD_REVEALED, open
+		);
+		memset(mines, 0, board_height * sizeof(BitRow));
+		queue_frontier(&solver);
+	}
+
+	uint8_t marked = solve(&solver, 1);
+
+	if (marked & UNFINISHED) {
+		return DEDUCED_UNFINISHED;
+	}
+
+	if (!(marked & MARKED_NEW)) {
+		return DEDUCED_NOTHING;
+	}
+
+	for (*row = 0; *row < board_height; (*row)++) {
+		for (*col = 0; *col < board_width; (*col)++) {
+			BitRow bit = (BitRow) 1 << *col;
+
+			if (safe[*row] & bit) {
+				return DEDUCED_SAFE;
+			}
+
+			if ((mines[*row] & bit) && !field_is_flagged(board[*row][*col])) {
+				return DEDUCED_MINE;
+			}
+		}
+	}
+
+	return DEDUCED_NOTHING;
+}
+
+static uint16_t bitboard_count(uint8_t board_height, const BitRow rows[])
+{
+	uint16_t count = 0;
+
+	for (uint8_t row = 0; row < board_height; row++) {
+		for (BitRow bits = rows[row]; bits; bits &= bits - 1) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/**
+ * Pick a random field from a bitboard.
+ *
+ * @return: 0 if the bitboard is empty, 1 otherwise.
+ */
+static uint8_t pick_field(
+	uint8_t board_height, const BitRow rows[], uint8_t *row, uint8_t *col
+) {
+	uint16_t count = bitboard_count(board_height, rows);
+
+	if (!count) {
+		return 0;
+	}
+
+	uint16_t skip = random_below(count);
+
+	for (*row = 0; *row < board_height; (*row)++) {
+		BitRow bits = rows[*row];
+
+		for (*col = 0; bits; (*col)++, bits >>= 1) {
+			if ((bits & 1) && !skip--) {
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Get a bitboard of the fields without neighbouring mines.
+ */
+static void empty_fields(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width], BitRow empty[]
+) {
+	for (uint8_t row = 0; row < board_height; row++) {
+		BitRow mask = 0;
+
+		for (uint8_t col = board_width; col-- > 0;) {
+			mask = (mask << 1) | (field_num_mines(board[row][col]) == 0);
+		}
+
+		empty[row] = mask;
+	}
+}
+
+/**
+ * Get the fields of a row next to revealed fields,
+ * which are neither revealed nor deduced.
+ */
+static BitRow stuck_row(const Solver *solver, uint8_t row)
+{
+	BitRow around = 0;
+
+	for (int16_t src = (int16_t) row - 1; src <= row + 1; src++) {
+		if (src >= 0 && src < solver->height) {
+			BitRow open = solver->open[src];
+
+			around |= open | open << 1 | open >> 1;
+		}
+	}
+
+	return around & unknown_row(solver, row);
+}
+
+/**
+ * Swap a random field where the solver got stuck, next to the revealed
+ * fields, with a field of the other kind, so a mine is moved into
+ * or out of the fields the solver could not deduce.
+ *
+ * @scratch: used as scratch space
+ */
+static void relocate_mine(
+	const Solver *solver, Field board[solver->height][solver->width],
+	BitRow scratch[]
+) {
+	uint8_t row;
+	uint8_t col;
+	uint8_t other_row;
+	uint8_t other_col;
+
+	for (uint8_t i = 0; i < solver->height; i++) {
+		scratch[i] = stuck_row(solver, i);
+	}
+
+	if (!pick_field(solver->height, scratch, &row, &col)) {
+		return;
+	}
+
+	uint8_t mine = field_is_mine(board[row][col]) != 0;
+
+	// Fields away from the revealed ones are tried first, so the swap
+	// changes the fields the solver is stuck on rather than shuffling
+	// mines between them.
+	for (uint8_t near = 0; near < 2; near++) {
+		for (uint8_t i = 0; i < solver->height; i++) {
+			BitRow stuck = stuck_row(solver, i);
+			BitRow bits = unknown_row(solver, i) & (near ? stuck : ~stuck);
+			BitRow other = 0;
+
+			for (uint8_t j = solver->width; j-- > 0;) {
+				uint8_t other_mine = field_is_mine(board[i][j]) != 0;
+
+				other = (other << 1) | (((bits >> j) & 1) && other_mine != mine);
+			}
+
+			scratch[i] = other;
+		}
+
+		if (pick_field(solver->height, scratch, &other_row, &other_col)) {
+			if (mine) {
+				move_mine(
+					row, col, other_row, other_col,
+					solver->width, solver->height, board
+				);
+			} else {
+				move_mine(
+					other_row, other_col, row, col,
+					solver->width, solver->height, board
+				);
+			}
+
+			return;
+		}
+	}
+}
+
+/**
+ * Check whether every empty field is revealed.
+ */
+static uint8_t is_solved(
+	const Solver *solver, Field board[solver->height][solver->width]
+) {
+	for (uint8_t row = 0; row < solver->height; row++) {
+		BitRow hidden = ~solver->open[row] & bitrow_mask(solver->width);
+
+		for (uint8_t col = 0; hidden; col++, hidden >>= 1) {
+			if ((hidden & 1) && !field_is_mine(board[row][col])) {
+				return 0;
+			}
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Clear the mines of the board and generate them again,
+ * keeping the flags placed.
+ */
+static void regenerate_mines(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width], uint16_t mine_amount
+) {
+	for (uint8_t i = 0; i < board_height; i++) {
+		for (uint8_t j = 0; j < board_width; j++) {
+			field_clear(&board[i][j], FIELD_MINE);
+		}
+	}
+
+	generate_mines(board_width, board_height, board, mine_amount);
+}
+
+/**
+ * Start playing the board from the given field with the solver alone.
+ *
+ * @empty: the bitboard of fields without neighbouring mines,
+ *	given to the solver
+ */
+static void start_board(
+	Solver *solver, Field board[solver->height][solver->width],
+	BitRow empty[], uint8_t row, uint8_t col
+) {
+	size_t size = solver->height * sizeof(BitRow);
+
+	empty_fields(solver->width, solver->height, board, empty);
+	memset(solver->open, 0, size);
+	memset(solver->mines, 0, size);
+	memset(solver->safe, 0, size);
+	memset(solver->pending, 0, size);
+	memset(solver->pending_pairs, 0, size);
+	solver_open(solver, row, (BitRow) 1 << col);
+	queue_frontier(solver);
+}
+
+Generation solver_generate(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width],
+	uint16_t mine_amount, uint8_t row, uint8_t col,
+	BitRow progress[SOLVER_GENERATE_BITBOARDS * board_height],
+	uint16_t *tried
+) {
+	BitRow *empty = progress;
+	uint16_t work = SOLVER_GENERATE_WORK;
+	Solver solver = {
+		board_width, board_height, &board[0][0],
+		progress + board_height, progress + 2 * board_height,
+		progress + 3 * board_height, progress + 4 * board_height,
+		progress + 5 * board_height, empty, &work
+	};
+
+	if (!*tried) {
+		clear_opening(row, col, board_width, board_height, board);
+	} else {
+		if (solve(&solver, 0) & UNFINISHED) {
+			return GENERATED_UNFINISHED;
+		}
+
+		if (is_solved(&solver, board)) {
+			return GENERATED_SOLVABLE;
+		}
+
+		if (*tried >= SOLVER_BOARD_LIMIT) {
+			return GENERATED_UNSOLVABLE;
+		}
+
+		if (*tried % SOLVER_RELOCATIONS) {
+			relocate_mine(&solver, board, solver.pending);
+		} else {
+			// Boards which stay stuck are generated again.
+			regenerate_mines(board_width, board_height, board, mine_amount);
+			clear_opening(row, col, board_width, board_height, board);
+		}
+	}
+
+	// The board is only solved on the next call,
+	// so a call never reads every field twice.
+	(*tried)++;
+	start_board(&solver, board, empty, row, col);
+
+	return GENERATED_UNFINISHED;
+}
@@ -0,0 +1,149 @@
+/**
+ * Deterministic solver
+ * for the AVR Mines game.
+ *
+ * Fields are deduced to be safe or mines from the numbers of the
+ * revealed fields alone, never from flags, which may be wrong.
+ * Two rules are applied:
+ *  - a revealed field whose mines are all known has only safe unknown
+ *    neighbours, while one with as many unknown neighbours as mines
+ *    left has only mines around it;
+ *  - for two revealed fields up to two fields apart, if the difference
+ *    of their mines left equals the amount of unknown fields next to
+ *    the first one only, those are all mines and the unknown fields
+ *    next to the second one only are all safe.
+ *
+ * Only the frontier of revealed fields next to unknown ones is
+ * visited. It is found with bitboards, so the fields themselves
+ * are only read at the frontier.
+ *
+ * Boards may not be wider than BITBOARD_MAX_WIDTH.
+ */
+
+#ifndef MINES_SOLVER
+#define MINES_SOLVER
+
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "board.h"
+
+// Revealed fields checked by a call of solver_hint at most, which
+// bounds the time it takes. Fields compared in pairs cost more,
+// so each of them counts as SOLVER_PAIR_WORK fields checked alone.
+#define SOLVER_HINT_WORK 96
+#define SOLVER_PAIR_WORK 8
+// Bitboards of the progress kept by a hint between calls.
+#define SOLVER_HINT_BITBOARDS 4
+// Fields checked by a call of solver_generate at most, counted as for
+// SOLVER_HINT_WORK, besides starting another board.
+#define SOLVER_GENERATE_WORK 96
+// Bitboards of the progress kept by solver_generate between calls.
+#define SOLVER_GENERATE_BITBOARDS 6
+// Mines swapped by solver_generate before generating them again.
+#define SOLVER_RELOCATIONS 32
+// Boards tried by solver_generate before keeping the last one,
+// which bounds the time taken by generation. On the host, 0.6% of
+// Expert boards need more, and 0.005% of Intermediate ones.
+#define SOLVER_BOARD_LIMIT 128
+
+/**
+ * Represent what a hint found out about a field.
+ */
+typedef enum deduction {
+	DEDUCED_NOTHING,
+	DEDUCED_SAFE,
+	DEDUCED_MINE,
+	DEDUCED_UNFINISHED
+} Deduction;
+
+/**
+ * Represent the outcome of a call of solver_generate.
+ */
+typedef enum generation {
+	GENERATED_SOLVABLE,
+	GENERATED_UNSOLVABLE,
+	GENERATED_UNFINISHED
+} Generation;
+
+/**
+ * Apply the rules until nothing else can be deduced.
+ * The board is not changed: the fields in @open are taken as revealed,
+ * so the solver may also play boards which are not being displayed.
+ *
+ * @open: fields taken as revealed, whose numbers are read
+ * @mines: fields known to be mines, to which those deduced are added
+ * @safe: fields known to be safe, to which those deduced are added.
+ *	They are not revealed, so their numbers are not used
+ *
+ * @return: 1 if anything was deduced, 0 otherwise.
+ */
+uint8_t solver_deduce(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width],
+	const BitRow open[board_height],
+	BitRow mines[board_height], BitRow safe[board_height]
+);
+
+/**
+ * Find an unrevealed field which is surely safe or an unflagged
+ * field which is surely a mine, from the fields revealed in the board.
+ * Rules are only applied until such a field is found, and at most
+ * SOLVER_HINT_WORK fields are checked per call. A hint which runs
+ * out of work is carried on by calling again, until it returns
+ * anything else.
+ *
+ * @row: the row of the field will be returned in this pointer
+ * @col: the column of the field will be returned in this pointer
+ * @progress: the fields revealed when the hint started, the mines
+ *	deduced and the fields left to check, kept between its calls
+ * @resumed: 1 to carry on with a hint which returned
+ *	DEDUCED_UNFINISHED, 0 to start a new one.
+ *	No field may be revealed in between
+ *
+ * @return: what was deduced about the field, DEDUCED_UNFINISHED if
+ *	the hint ran out of work, or DEDUCED_NOTHING if no field
+ *	could be deduced.
+ */
+Deduction solver_hint(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width],
+	uint8_t *row, uint8_t *col,
+	BitRow progress[SOLVER_HINT_BITBOARDS * board_height], uint8_t resumed
+);
+
+/**
+ * Make the board solvable by solver_deduce alone, starting from
+ * revealing the given field, so no guess is ever needed.
+ * The field is first cleared into an opening with clear_opening.
+ *
+ * Where the solver gets stuck, a mine next to the revealed fields
+ * is swapped with a free field further away, or the other way around,
+ * with move_mine. After SOLVER_RELOCATIONS swaps in a row,
+ * the mines are generated again instead.
+ * No field may be revealed yet, while flags are kept.
+ *
+ * Like hints, generation is carried on by calling again until it
+ * returns anything else. Each call starts at most one board, which
+ * reads every field, and checks at most SOLVER_GENERATE_WORK fields.
+ *
+ * @mine_amount: the amount of mines on the board
+ * @progress: the board being solved, kept between the calls
+ * @tried: the amount of boards tried, kept between the calls.
+ *	It must be 0 to start generating
+ *
+ * @return: GENERATED_SOLVABLE if the board is solvable,
+ *	GENERATED_UNFINISHED if the call ran out of work, or
+ *	GENERATED_UNSOLVABLE if none of SOLVER_BOARD_LIMIT boards was
+ *	solvable, in which case the last one tried is kept.
+ *	It still opens a section from the field.
+ */
+Generation solver_generate(
+	uint8_t board_width, uint8_t board_height,
+	Field board[board_height][board_width],
+	uint16_t mine_amount, uint8_t row, uint8_t col,
+	BitRow progress[SOLVER_GENERATE_BITBOARDS * board_height],
+	uint16_t *tried
+);
+
+#endif
@@ -1,94 +1,217 @@
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 
 #include <stdint.h>
-#include <stdio.h>
+#include <string.h>
 
 #include "board.h"
 #include "chars.h"
+#include "format.h"
 #include "nokia5110.h"
+#include "writing.h"
 
 void write_board(
 	uint8_t board_width, uint8_t board_height,
 	Field board[board_height][board_width],
+	BitRow changes[board_height],
+	uint8_t view_x, uint8_t view_y,
 	uint8_t sel_x, uint8_t sel_y,
 	State game_state
 ) {
-	for (uint8_t row = 0; row < board_height; row++) {
-		// Set the cursor to the start of the line.
-		nokia_lcd_set_cursor(0, row * 8);
+	uint8_t visible_width =
+		board_width < SCREEN_COLUMNS ? board_width : SCREEN_COLUMNS;
+	uint8_t visible_height =
+		board_height < SCREEN_ROWS ? board_height : SCREEN_ROWS;
+
+	for (uint8_t line = 0; line < visible_height; line++) {
+		uint8_t row = view_y + line;
+		BitRow changed =
+			(changes[row] >> view_x) & bitrow_mask(visible_width);
+
+		for (uint8_t cell = 0; changed; cell++, changed >>= 1) {
+			if (!(changed & 1)) {
+				continue;
+			}
+
+			uint8_t col = view_x + cell;
+
+			// Fields are 6 pixels wide, including their spacing.
+			nokia_lcd_set_cursor(cell * 6, line * 8);
 
-		for (uint8_t col = 0; col < board_width; col++) {
 			if (
 				row == sel_y && col == sel_x
 				&& (game_state == START || game_state == PLAYING)
 			) {
-				nokia_lcd_write_string("\003", 1);
+				nokia_lcd_write_char('\003', 1);
 				continue;
 			}
 
 			Field field = board[row][col];
 
-			if (!field.revealed) {
-				if (field.flagged) {
-					nokia_lcd_write_string("\004", 1);
+			if (!field_is_revealed(field)) {
+				if (field_is_flagged(field)) {
+					nokia_lcd_write_char('\004', 1);
 				}
 				else {
-					nokia_lcd_write_string("\002", 1);
+					nokia_lcd_write_char('\002', 1);
 				}
-			} else if (field.mine) {
-				nokia_lcd_write_string("\005", 1);
+			} else if (field_is_mine(field)) {
+				nokia_lcd_write_char('\005', 1);
 			} else {
-				if (field.num_mines > 0) {
-					char value[4];
-					sprintf(value, "%d", field.num_mines);
-					nokia_lcd_write_string(value, 1);
+				if (field_num_mines(field) > 0) {
+					// The count is a single digit.
+					nokia_lcd_write_char('0' + field_num_mines(field), 1);
 				} else {
-					nokia_lcd_write_string(" ", 1);
+					nokia_lcd_write_char(' ', 1);
 				}
 			}
 		}
 	}
+
+	// Fields outside of the window are written once they are scrolled to.
+	memset(changes, 0, board_height * sizeof(BitRow));
+}
+
+uint8_t view_follow(uint8_t view, uint8_t sel, uint8_t limit, uint8_t window)
+{
+	if (limit <= window) {
+		return 0;
+	}
+
+	if (sel < view + VIEW_MARGIN) {
+		view = sel > VIEW_MARGIN ? sel - VIEW_MARGIN : 0;
+	} else if (sel + VIEW_MARGIN >= view + window) {
+		view = sel + VIEW_MARGIN + 1 - window;
+	}
+
+	return view + window > limit ? limit - window : view;
 }
 
 void write_flag_count(
 	uint8_t x, uint8_t y,
-	uint8_t flags_placed, uint8_t mine_amount
+	uint16_t flags_placed, uint16_t mine_amount
 ) {
-	char flags[7];
-	sprintf(flags, "%02d/%02d\004", flags_placed, mine_amount);
+	char flags[14];
+	uint8_t length = format_decimal(flags, flags_placed, 2);
+
+	flags[length++] = '/';
+	length += format_decimal(flags + length, mine_amount, 2);
+	flags[length++] = '\004';
+	flags[length] = '\0';
+
 	nokia_lcd_set_cursor(x, y);
+
+	// Characters are 6 pixels wide, including their spacing.
+	for (uint8_t pad = (84 - x) / 6; pad > length; pad--) {
+		nokia_lcd_write_char(' ', 1);
+	}
+
 	nokia_lcd_write_string(flags, 1);
 }
 
 void write_timer(
 	uint8_t x, uint8_t y, uint8_t min, uint8_t sec
 ) {
-	char time_display[7];
-	sprintf(time_display, "\001%02d:%02d", min, sec);
+	char time_display[9];
+
+	// Filled in place, as an initialized array is copied from .data.
+	time_display[0] = '\001';
+	format_time(time_display + 1, min, sec);
 	nokia_lcd_set_cursor(x, y);
 	nokia_lcd_write_string(time_display, 1);
 }
 
+void write_generating(uint8_t x, uint8_t y, uint16_t boards_tried)
+{
+	char tried[6];
+	uint8_t length = format_decimal(tried, boards_tried, 0);
+
+	nokia_lcd_set_cursor(x, y);
+	nokia_lcd_write_string_P(PSTR("Generating"), 1);
+
+	// Aligned to the end of the line, like the flag count.
+	for (uint8_t pad = (84 - x) / 6 - 10; pad > length; pad--) {
+		nokia_lcd_write_char(' ', 1);
+	}
+
+	nokia_lcd_write_string(tried, 1);
+}
+
 void write_victory(uint8_t x, uint8_t y)
 {
 	nokia_lcd_set_cursor(x, y);
-	nokia_lcd_write_string("B)  Win  FLAG ", 1);
+	nokia_lcd_write_string_P(PSTR("B)  Win  FLAG "), 1);
 }
 
 void write_defeat(uint8_t x, uint8_t y)
 {
 	nokia_lcd_set_cursor(x, y);
-	nokia_lcd_write_string("xO Defeat FLAG", 1);
+	nokia_lcd_write_string_P(PSTR("xO Defeat FLAG"), 1);
 }
 
 void write_menu()
 {
-	nokia_lcd_write_string(
-		"              "
-		" AVR \005 Mines! "
-		"              "
-		" Press CHECK! "
-		"			   ",
+	nokia_lcd_set_cursor(0, 0);
+	nokia_lcd_write_string_P(
+		PSTR(
+			"              "
+			" AVR \005 Mines! "
+			"              "
+		),
 		1
 	);
+
+	nokia_lcd_set_cursor(0, 5 * 8);
+	nokia_lcd_write_string_P(PSTR(" Press CHECK! "), 1);
+}
+
+/**
+ * Write a string centered between spaces.
+ *
+ * @length: the length of the string
+ * @cells: the amount of characters to write, including the spaces
+ */
+static void write_centered(const char *str, uint8_t length, uint8_t cells)
+{
+	uint8_t left = (cells - length) / 2;
+
+	for (uint8_t i = 0; i < cells; i++) {
+		if (i >= left && i < left + length) {
+			nokia_lcd_write_char(str[i - left], 1);
+		} else {
+			nokia_lcd_write_char(' ', 1);
+		}
+	}
+}
+
+void write_mode(uint8_t y, uint8_t no_guess)
+{
+	nokia_lcd_set_cursor(0, y);
+	nokia_lcd_write_string_P(
+		no_guess ? PSTR("^No guessing v") : PSTR("^  Guessing  v"), 1
+	);
+}
+
+void write_difficulty(
+	uint8_t y, const char *name,
+	uint8_t width, uint8_t height, uint16_t mine_amount
+) {
+	char line[15];
+	uint8_t length;
+
+	strcpy_P(line, name);
+	nokia_lcd_set_cursor(0, y);
+	nokia_lcd_write_char('<', 1);
+	write_centered(line, strlen(line), 12);
+	nokia_lcd_write_char('>', 1);
+
+	length = format_decimal(line, width, 0);
+	line[length++] = 'x';
+	length += format_decimal(line + length, height, 0);
+	line[length++] = ' ';
+	length += format_decimal(line + length, mine_amount, 0);
+	line[length++] = '\005';
+
+	nokia_lcd_set_cursor(0, y + 8);
+	write_centered(line, length, 14);
 }
@@ -10,29 +10,60 @@
 
 #include "board.h"
 
+// Fields which fit on the screen, above the status line.
+#define SCREEN_COLUMNS 14
+#define SCREEN_ROWS 5
+// Fields kept visible around the selected one while scrolling.
+#define VIEW_MARGIN 1
+
 /**
- * Write the board to the screen.
+ * Write the fields changed since the last call to the screen.
+ * Only the window of SCREEN_COLUMNS by SCREEN_ROWS fields
+ * starting at the view's position is shown, so the cost
+ * depends on the size of the window instead of the board.
  *
+ * @changes: the change log of the fields to write,
+ *	which is cleared once they are written, including fields
+ *	outside of the window. Set every bit to write the whole window
+ * @view_x: the first column shown
+ * @view_y: the first row shown
  * @sel_x: horizontal position of the selected field
  * @sel_y: vertical position of the selected field
  */
 void write_board(
 	uint8_t board_width, uint8_t board_height,
 	Field board[board_height][board_width],
+	BitRow changes[board_height],
+	uint8_t view_x, uint8_t view_y,
 	uint8_t sel_x, uint8_t sel_y,
 	State game_state
 );
 
+/**
+ * Scroll the view along the x or y axis, so the selected field and
+ * VIEW_MARGIN fields around it are shown, unless it is on a border.
+ *
+ * @view: the first column or row shown
+ * @sel: the column or row of the selected field
+ * @limit: the width or height of the board
+ * @window: the amount of columns or rows shown
+ *
+ * @return: the new first column or row shown
+ */
+uint8_t view_follow(uint8_t view, uint8_t sel, uint8_t limit, uint8_t window);
+
 /**
  * Write the amount of flags placed compared to
  * the number of mines in the board to the screen.
+ * The count is aligned to the end of the line and padded with
+ * spaces from the given position, so shorter counts replace longer ones.
  *
  * @x: horizontal position
  * @y: vertical position
  */
 void write_flag_count(
 	uint8_t x, uint8_t y,
-	uint8_t flags_placed, uint8_t mine_amount
+	uint16_t flags_placed, uint16_t mine_amount
 );
 
 /**
@@ -45,6 +76,15 @@ void write_timer(
 	uint8_t x, uint8_t y, uint8_t min, uint8_t sec
 );
 
+/**
+ * Write on the status line that a board without guessing is being
+ * generated, along with the boards tried so far.
+ *
+ * @x: horizontal position
+ * @y: vertical position
+ */
+void write_generating(uint8_t x, uint8_t y, uint16_t boards_tried);
+
 /**
  * Write the victory message to the screen.
  *
@@ -62,8 +102,30 @@ void write_victory(uint8_t x, uint8_t y);
 void write_defeat(uint8_t x, uint8_t y);
 
 /**
- * Write the start menu to the screen.
+ * Write the start menu to the screen,
+ * leaving the 3rd line to write_mode
+ * and the 4th and 5th lines to write_difficulty.
  */
 void write_menu();
 
+/**
+ * Write on a line of the screen whether boards
+ * are generated to be solvable without guessing.
+ *
+ * @y: vertical position
+ */
+void write_mode(uint8_t y, uint8_t no_guess);
+
+/**
+ * Write a difficulty preset on two lines of the screen:
+ * its name between arrows, then the board's size and mines.
+ *
+ * @y: vertical position of the first line
+ * @name: name of the preset, in program memory
+ */
+void write_difficulty(
+	uint8_t y, const char *name,
+	uint8_t width, uint8_t height, uint16_t mine_amount
+);
+
 #endif